@@ -0,0 +1,44 @@
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+using BenchArgs = std::vector<std::string>;
+
+// Runs fn once and returns the wall time it took, in seconds.
+template <typename F> double time_seconds(F &&fn) {
+  auto start = std::chrono::steady_clock::now();
+  fn();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// Best of `runs` timings. Loading and index benchmarks are noisy on a busy
+// machine, and the minimum is the most repeatable number.
+template <typename F> double best_of(int runs, F &&fn) {
+  double best = time_seconds(fn);
+  for (int i = 1; i < runs; i++)
+    best = std::min(best, time_seconds(fn));
+  return best;
+}
+
+// Suites. Each takes the command line arguments after its name and returns
+// the process exit code.
+int bench_load(const BenchArgs &args);
+int bench_store(const BenchArgs &args);
+int bench_bplus_build(const BenchArgs &args);
+int bench_bplus_values(const BenchArgs &args);
+int bench_bplus_search(const BenchArgs &args);
+int bench_flat_bplus(const BenchArgs &args);
+int bench_bplus_update(const BenchArgs &args);
+int bench_rb_build(const BenchArgs &args);
+int bench_rb_rank(const BenchArgs &args);
+int bench_cursor(const BenchArgs &args);
+int bench_write(const BenchArgs &args);
+int bench_snapshots(const BenchArgs &args);
+int bench_paged(const BenchArgs &args);
+int bench_quadtree(const BenchArgs &args);
+int bench_spatial(const BenchArgs &args);
+int bench_morton(const BenchArgs &args);
+int bench_quadtree_index(const BenchArgs &args);
@@ -0,0 +1,53 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/bplustree.hh"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// Point lookups and range starts on trees of random float keys.
+int bench_bplus_search(const BenchArgs &args) {
+  size_t count = args.empty() ? 1000000 : std::stoul(args[0]);
+  std::mt19937 gen(11);
+  std::uniform_real_distribution<float> key_dist(400000, 3000000);
+
+  std::vector<std::pair<float, RowId>> pairs;
+  for (size_t i = 0; i < count; i++)
+    pairs.emplace_back(key_dist(gen), static_cast<RowId>(i));
+  std::vector<float> probes;
+  for (size_t i = 0; i < 200000; i++)
+    probes.push_back(pairs[gen() % count].first);
+  std::sort(pairs.begin(), pairs.end());
+
+  std::cout << count << " keys, " << probes.size() << " probes" << std::endl;
+  for (size_t order : {3, 21, 64, 128, 256}) {
+    BPlusTree<float, RowId> tree(order, pairs);
+
+    size_t found = 0;
+    double lookup = best_of(3, [&] {
+      found = 0;
+      for (float key : probes)
+        found += tree.search(key) != nullptr;
+    });
+
+    size_t starts = 0;
+    double range = best_of(3, [&] {
+      starts = 0;
+      for (float key : probes)
+        starts += tree.getRange(key, key + 1).size();
+    });
+
+    if (found != probes.size()) {
+      std::cerr << "bench bplus-search: only found " << found << " keys"
+                << std::endl;
+      return 1;
+    }
+    std::cout << "  order " << std::setw(3) << order << "  search "
+              << std::fixed << std::setprecision(1) << std::setw(7)
+              << lookup * 1e9 / probes.size() << " ns  range start "
+              << std::setw(7) << range * 1e9 / probes.size() << " ns"
+              << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,69 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/bplustree.hh"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// A stream of price changes with a range query every tenth step, applied in
+// place with BPlusTree::update, against rebuilding the tree from scratch
+// (which is what a price change used to cost).
+int bench_bplus_update(const BenchArgs &args) {
+  if (args.empty() || args.size() > 2) {
+    std::cerr << "bench bplus-update: expected a data file" << std::endl;
+    return 1;
+  }
+  size_t steps = args.size() > 1 ? std::stoul(args[1]) : 200000;
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  if (houses.empty()) {
+    std::cerr << "bench bplus-update: no rows in " << args[0] << std::endl;
+    return 1;
+  }
+  std::vector<float> prices;
+  for (const House &h : houses)
+    prices.push_back(h.price);
+  std::cout << houses.size() << " rows, " << steps << " steps" << std::endl;
+
+  for (size_t order : {3, 21, 64}) {
+    std::vector<std::pair<float, RowId>> sorted;
+    for (size_t i = 0; i < prices.size(); i++)
+      sorted.emplace_back(prices[i], static_cast<RowId>(i));
+    std::sort(sorted.begin(), sorted.end());
+
+    BPlusTree<float, RowId> tree(order, sorted, 0.7);
+    std::vector<float> current = prices;
+    std::mt19937 gen(15);
+    std::uniform_real_distribution<float> change(0.9f, 1.1f);
+
+    size_t matches = 0, failed = 0;
+    double mixed = time_seconds([&] {
+      for (size_t step = 0; step < steps; step++) {
+        RowId row = static_cast<RowId>(gen() % current.size());
+        if (step % 10 == 9) {
+          float low = current[row];
+          matches += tree.getRange(low, low * 1.001f).size();
+          continue;
+        }
+        float price = current[row] * change(gen);
+        failed += !tree.update(current[row], price, row);
+        current[row] = price;
+      }
+    });
+
+    double rebuild = best_of(3, [&] { tree.bulkLoad(sorted, 0.7); });
+
+    if (failed) {
+      std::cerr << "bench bplus-update: " << failed << " updates failed"
+                << std::endl;
+      return 1;
+    }
+    std::cout << "  order " << std::setw(2) << order << "  " << std::fixed
+              << std::setprecision(0) << std::setw(6)
+              << mixed * 1e9 / steps << " ns per step  " << std::setprecision(1)
+              << std::setw(7) << rebuild * 1e3 << " ms per rebuild  ("
+              << matches << " matches)" << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,45 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/bplustree.hh"
+#include <iomanip>
+#include <iostream>
+
+template <typename V, typename MakeValue>
+static void run(const char *name, size_t order, std::vector<House> &houses,
+                MakeValue make_value) {
+  typename BPlusTree<float, V>::Stats stats;
+  size_t matches = 0;
+  double seconds = best_of(3, [&] {
+    BPlusTree<float, V> tree(order);
+    for (size_t i = 0; i < houses.size(); i++)
+      tree.insert(houses[i].price, make_value(i));
+    stats = tree.getStats();
+    matches = tree.getRange(1000000, 2000000).size();
+  });
+  std::cout << "  " << std::left << std::setw(8) << name << std::right
+            << std::fixed << std::setprecision(3) << std::setw(8) << seconds
+            << " s insert " << std::setw(8) << std::setprecision(1)
+            << stats.bytes / 1048576.0 << " MiB in nodes " << std::setw(9)
+            << matches << " matches" << std::endl;
+}
+
+// What the leaves hold: full House copies, pointers, or 32-bit row ids.
+int bench_bplus_values(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench bplus-values: expected a data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  std::cout << houses.size() << " rows" << std::endl;
+  for (size_t order : {3, 21}) {
+    std::cout << "order " << order << std::endl;
+    run<House>("House", order, houses,
+               [&](size_t i) { return houses[i]; });
+    run<House *>("House*", order, houses,
+                 [&](size_t i) { return &houses[i]; });
+    run<RowId>("RowId", order, houses,
+               [](size_t i) { return static_cast<RowId>(i); });
+  }
+  return 0;
+}
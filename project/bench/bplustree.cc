@@ -0,0 +1,62 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/bplustree.hh"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+static void report(const char *name, double seconds,
+                   const BPlusTree<float, House *>::Stats &stats) {
+  std::cout << "  " << std::left << std::setw(16) << name << std::right
+            << std::fixed << std::setprecision(3) << std::setw(8) << seconds
+            << " s  height " << stats.height << "  leaves " << std::setw(8)
+            << stats.leaves << "  leaf fill " << std::setprecision(2)
+            << stats.leafFill << std::endl;
+}
+
+// Per-row insert vs sort + bottom-up bulk load.
+int bench_bplus_build(const BenchArgs &args) {
+  if (args.empty()) {
+    std::cerr << "bench bplus-build: expected a data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  std::vector<size_t> orders;
+  for (size_t i = 1; i < args.size(); i++)
+    orders.push_back(std::stoul(args[i]));
+  if (orders.empty())
+    orders = {3, 21};
+
+  std::cout << houses.size() << " rows" << std::endl;
+  for (size_t order : orders) {
+    std::cout << "order " << order << std::endl;
+
+    BPlusTree<float, House *>::Stats stats;
+    double insert_time = best_of(3, [&] {
+      BPlusTree<float, House *> tree(order);
+      for (House &h : houses)
+        tree.insert(h.price, &h);
+      stats = tree.getStats();
+    });
+    report("insert", insert_time, stats);
+
+    for (double fill : {1.0, 0.75}) {
+      double bulk_time = best_of(3, [&] {
+        std::vector<std::pair<float, House *>> pairs;
+        pairs.reserve(houses.size());
+        for (House &h : houses)
+          pairs.emplace_back(h.price, &h);
+        std::stable_sort(pairs.begin(), pairs.end(),
+                         [](const auto &a, const auto &b) {
+                           return a.first < b.first;
+                         });
+        BPlusTree<float, House *> tree(order, pairs, fill);
+        stats = tree.getStats();
+      });
+      std::string name = "sort+bulk " + std::to_string(fill).substr(0, 4);
+      report(name.c_str(), bulk_time, stats);
+    }
+  }
+  return 0;
+}
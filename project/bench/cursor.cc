@@ -0,0 +1,66 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/flat_bplustree.hh"
+#include "structures/redblack.hh"
+#include <iomanip>
+#include <iostream>
+
+// A wide price range the way the app pages through it: the eager vector of
+// every match, against counting the matches once (Ingest::search_count) and
+// pulling page 100's four houses (Ingest::search_page).
+int bench_cursor(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench cursor: expected a data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  RedBlackTree rbtree;
+  FlatBPlusTree<float, RowId, 21> bplus;
+  for (size_t i = 0; i < houses.size(); i++) {
+    rbtree.insert(houses[i].price, static_cast<RowId>(i));
+    bplus.insert(houses[i].price, static_cast<RowId>(i));
+  }
+  std::cout << houses.size() << " rows" << std::endl;
+
+  const size_t page = 100, per_page = 4;
+  for (float width : {100000.0f, 1000000.0f, 10000000.0f}) {
+    float min = 1000000, max = min + width;
+    size_t matches = 0, counted = 0;
+
+    double rb_eager = best_of(3, [&] {
+      matches = rbtree.price_range(min, max).size();
+    });
+    double rb_count = best_of(3, [&] {
+      counted = rbtree.count_in_range(min, max);
+    });
+    double rb_page = best_of(3, [&] {
+      for (size_t i = 0; i < per_page; i++)
+        rbtree.select_in_range(min, max, page * per_page + i);
+    });
+    double bp_eager = best_of(3, [&] {
+      matches = bplus.getRange(min, max, houses).size();
+    });
+    size_t bp_counted = 0;
+    double bp_count = best_of(3, [&] {
+      bp_counted = bplus.countRange(min, max);
+    });
+    double bp_page = best_of(3, [&] {
+      auto cursor = bplus.range(min, max);
+      cursor.skip(page * per_page);
+      for (size_t i = 0; i < per_page; i++)
+        cursor.next();
+    });
+
+    if (counted != matches || bp_counted != matches) {
+      std::cerr << "bench cursor: counts disagree" << std::endl;
+      return 1;
+    }
+    std::cout << std::fixed << std::setprecision(1) << "  " << std::setw(8)
+              << matches << " matches (us: all / count / page)  red-black "
+              << rb_eager * 1e6 << " / " << rb_count * 1e6 << " / "
+              << rb_page * 1e6 << "  B+21 " << bp_eager * 1e6 << " / "
+              << bp_count * 1e6 << " / " << bp_page * 1e6 << std::endl;
+  }
+  return 0;
+}
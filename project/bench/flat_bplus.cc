@@ -0,0 +1,81 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/bplustree.hh"
+#include "structures/flat_bplustree.hh"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+template <typename Tree>
+static void run(const char *name, size_t order,
+                const std::vector<std::pair<float, RowId>> &pairs,
+                const std::vector<std::pair<float, RowId>> &sorted,
+                const std::vector<float> &probes) {
+  double insert = best_of(3, [&] {
+    Tree tree(order);
+    for (const auto &kv : pairs)
+      tree.insert(kv.first, kv.second);
+  });
+
+  Tree tree(order);
+  for (const auto &kv : pairs)
+    tree.insert(kv.first, kv.second);
+  double build = best_of(3, [&] { tree.bulkLoad(sorted); });
+
+  size_t found = 0;
+  double lookup = best_of(3, [&] {
+    found = 0;
+    for (float key : probes)
+      found += tree.search(key) != nullptr;
+  });
+
+  // A wide price band, mostly leaf scanning.
+  size_t matches = 0;
+  double scan = best_of(3, [&] {
+    matches = tree.getRange(1000000, 2000000).size();
+  });
+
+  std::cout << "  " << std::left << std::setw(6) << name << std::right
+            << std::fixed << std::setprecision(3) << std::setw(7) << insert
+            << " s insert " << std::setw(7) << build << " s bulk "
+            << std::setprecision(1) << std::setw(7)
+            << lookup * 1e9 / probes.size() << " ns search " << std::setw(7)
+            << scan * 1e3 << " ms scan (" << matches << ") " << std::setw(6)
+            << tree.getStats().bytes / 1048576.0 << " MiB" << std::endl;
+  if (found != probes.size())
+    std::cerr << "  " << name << ": only found " << found << " keys"
+              << std::endl;
+}
+
+// BPlusTree's node objects against FlatBPlusTree's arena of cache-line
+// blocks, with a runtime order and (for the app's 3 and 21) a compile-time
+// one, on random float keys with row id values.
+int bench_flat_bplus(const BenchArgs &args) {
+  size_t count = args.empty() ? 1000000 : std::stoul(args[0]);
+  std::mt19937 gen(13);
+  std::uniform_real_distribution<float> key_dist(400000, 3000000);
+
+  std::vector<std::pair<float, RowId>> pairs;
+  for (size_t i = 0; i < count; i++)
+    pairs.emplace_back(key_dist(gen), static_cast<RowId>(i));
+  std::vector<float> probes;
+  for (size_t i = 0; i < 200000; i++)
+    probes.push_back(pairs[gen() % count].first);
+  std::vector<std::pair<float, RowId>> sorted = pairs;
+  std::sort(sorted.begin(), sorted.end());
+
+  std::cout << count << " keys" << std::endl;
+  for (size_t order : {3, 21, 64}) {
+    std::cout << "order " << order << std::endl;
+    run<BPlusTree<float, RowId>>("nodes", order, pairs, sorted, probes);
+    run<FlatBPlusTree<float, RowId>>("flat", order, pairs, sorted, probes);
+    if (order == 3)
+      run<FlatBPlusTree<float, RowId, 3>>("fixed", order, pairs, sorted,
+                                          probes);
+    if (order == 21)
+      run<FlatBPlusTree<float, RowId, 21>>("fixed", order, pairs, sorted,
+                                           probes);
+  }
+  return 0;
+}
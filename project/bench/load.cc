@@ -0,0 +1,73 @@
+#include "bench.hh"
+#include "io/snapshot.hh"
+#include "lib.hh"
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+
+struct LoadModeInfo {
+  const char *name;
+  LoadMode mode;
+};
+
+static const LoadModeInfo modes[] = {
+    {"stream", LoadMode::Stream},
+    {"mapped", LoadMode::Mapped},
+    {"parallel", LoadMode::Parallel},
+};
+
+static void report(const char *name, size_t rows, double seconds,
+                   double baseline) {
+  std::cout << "  " << std::left << std::setw(8) << name << std::right
+            << std::setw(10) << rows << " rows " << std::fixed
+            << std::setprecision(3) << std::setw(9) << seconds << " s "
+            << std::setw(14) << std::setprecision(0) << rows / seconds
+            << " rows/s " << std::setprecision(2) << std::setw(6)
+            << baseline / seconds << "x" << std::endl;
+}
+
+int bench_load(const BenchArgs &args) {
+  if (args.empty()) {
+    std::cerr << "bench load: expected at least one data file" << std::endl;
+    return 1;
+  }
+
+  for (const std::string &file : args) {
+    std::cout << file << std::endl;
+
+    size_t expected_rows = 0;
+    double baseline = 0;
+    for (const LoadModeInfo &info : modes) {
+      size_t rows = 0;
+      double seconds =
+          best_of(3, [&] { rows = load_file(file, info.mode).size(); });
+
+      if (info.mode == LoadMode::Stream) {
+        expected_rows = rows;
+        baseline = seconds;
+      } else if (rows != expected_rows) {
+        std::cerr << "  " << info.name << " loaded " << rows
+                  << " rows, expected " << expected_rows << std::endl;
+        return 1;
+      }
+      report(info.name, rows, seconds, baseline);
+    }
+
+    // Same rows again, from a binary snapshot.
+    std::string snapshot = file + ".snapshot";
+    if (!write_snapshot(snapshot, load_file(file, LoadMode::Parallel))) {
+      std::cerr << "  could not write " << snapshot << std::endl;
+      return 1;
+    }
+    size_t rows = 0;
+    double seconds = best_of(3, [&] { rows = load_file(snapshot).size(); });
+    std::remove(snapshot.c_str());
+    if (rows != expected_rows) {
+      std::cerr << "  snapshot loaded " << rows << " rows, expected "
+                << expected_rows << std::endl;
+      return 1;
+    }
+    report("snapshot", rows, seconds, baseline);
+  }
+  return 0;
+}
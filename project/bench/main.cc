@@ -0,0 +1,54 @@
+#include "bench.hh"
+#include <iostream>
+#include <string>
+
+struct Suite {
+  const char *name;
+  const char *usage;
+  int (*run)(const BenchArgs &args);
+};
+
+static const Suite suites[] = {
+    {"load", "<data file>...", bench_load},
+    {"store", "<data file>", bench_store},
+    {"bplus-build", "<data file> [order]...", bench_bplus_build},
+    {"bplus-values", "<data file>", bench_bplus_values},
+    {"bplus-search", "[key count]", bench_bplus_search},
+    {"flat-bplus", "[key count]", bench_flat_bplus},
+    {"bplus-update", "<data file> [steps]", bench_bplus_update},
+    {"rb-build", "<data file>", bench_rb_build},
+    {"rb-rank", "<data file>", bench_rb_rank},
+    {"cursor", "<data file>", bench_cursor},
+    {"write", "<data file>", bench_write},
+    {"snapshots", "<data file>", bench_snapshots},
+    {"paged", "<data file> [pool pages]...", bench_paged},
+    {"quadtree", "<data file> [bucket size]...", bench_quadtree},
+    {"spatial", "<data file>", bench_spatial},
+    {"morton", "<data file | point count>", bench_morton},
+    {"quadtree-index", "<data file>", bench_quadtree_index},
+};
+
+static void print_usage() {
+  std::cerr << "Usage: bench <suite> [args]\nSuites:\n";
+  for (const Suite &suite : suites) {
+    std::cerr << "  " << suite.name << " " << suite.usage << "\n";
+  }
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    print_usage();
+    return 1;
+  }
+
+  std::string name = argv[1];
+  BenchArgs args(argv + 2, argv + argc);
+  for (const Suite &suite : suites) {
+    if (name == suite.name)
+      return suite.run(args);
+  }
+
+  std::cerr << "Unknown suite: " << name << "\n";
+  print_usage();
+  return 1;
+}
@@ -0,0 +1,126 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/bucket_quadtree.hh"
+#include "structures/morton_quadtree.hh"
+#include "structures/quadtree.hh"
+#include <algorithm>
+#include <cctype>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+
+// Quadtree, BucketQuadtree and MortonQuadtree on the same positions: build
+// time, memory and radius search time. Given a count instead of a file, the
+// points are generated (uniform over a 100000 unit square), which reaches
+// 10M points without holding 10M Houses.
+static void report(const char *name, double build, const QuadtreeStats &stats,
+                   const std::vector<double> &searches, size_t queries) {
+  std::cout << std::fixed << std::setprecision(2) << "  " << std::setw(10)
+            << std::left << name << std::right << " build " << std::setw(6)
+            << build << " s  " << std::setw(9) << stats.nodes
+            << " nodes  depth " << std::setw(2) << stats.max_depth << "  "
+            << std::setprecision(1) << std::setw(5)
+            << double(stats.bytes) / stats.items << " bytes/item ";
+  for (double search : searches)
+    std::cout << " " << std::setprecision(2) << std::setw(8)
+              << search / queries * 1e6 << " us";
+  std::cout << std::endl;
+}
+
+template <typename Tree>
+static std::vector<double> search(Tree &tree,
+                                  const std::vector<sf::Vector2f> &centers,
+                                  const std::vector<float> &radii,
+                                  std::vector<size_t> &found) {
+  std::vector<double> times;
+  found.clear();
+  for (float radius : radii) {
+    size_t total = 0;
+    times.push_back(best_of(3, [&] {
+      total = 0;
+      for (sf::Vector2f center : centers)
+        total += tree.find_in_radius(center, radius).size();
+    }));
+    found.push_back(total);
+  }
+  return times;
+}
+
+int bench_morton(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench morton: expected a data file or a point count"
+              << std::endl;
+    return 1;
+  }
+
+  std::vector<sf::Vector2f> points;
+  if (std::all_of(args[0].begin(), args[0].end(), ::isdigit)) {
+    std::mt19937 rng(23);
+    std::uniform_real_distribution<float> coordinate(0.0f, 100000.0f);
+    points.resize(std::stoul(args[0]));
+    for (sf::Vector2f &p : points)
+      p = {coordinate(rng), coordinate(rng)};
+  } else {
+    std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+    points.reserve(houses.size());
+    for (const House &house : houses)
+      points.push_back(house.position);
+  }
+  if (points.empty()) {
+    std::cerr << "bench morton: no points" << std::endl;
+    return 1;
+  }
+
+  std::mt19937 rng(24);
+  std::vector<sf::Vector2f> centers;
+  for (int i = 0; i < 1000; i++)
+    centers.push_back(points[rng() % points.size()]);
+  const std::vector<float> radii = {50.0f, 200.0f, 1600.0f};
+
+  std::cout << points.size() << " points, 1000 queries at radius";
+  for (float radius : radii)
+    std::cout << " " << radius;
+  std::cout << std::endl;
+
+  std::vector<size_t> expected, found;
+  {
+    Quadtree<sf::Vector2f> tree;
+    double build = time_seconds([&] {
+      for (sf::Vector2f p : points)
+        tree.add_item(sf::Vector2f(p));
+    });
+    report("quadtree", build, tree.stats(),
+           search(tree, centers, radii, expected), centers.size());
+  }
+  {
+    BucketQuadtree<sf::Vector2f> tree(16);
+    double build = time_seconds([&] {
+      for (sf::Vector2f p : points)
+        tree.add_item(sf::Vector2f(p));
+    });
+    report("bucket 16", build, tree.stats(),
+           search(tree, centers, radii, found), centers.size());
+    if (found != expected) {
+      std::cerr << "bench morton: BucketQuadtree disagrees" << std::endl;
+      return 1;
+    }
+  }
+  for (size_t leaf : {16, 64}) {
+    MortonQuadtree<sf::Vector2f> tree(leaf);
+    double build = time_seconds([&] { tree.build(points); });
+    std::string name = "morton " + std::to_string(leaf);
+    report(name.c_str(), build, tree.stats(),
+           search(tree, centers, radii, found), centers.size());
+    if (found != expected) {
+      std::cerr << "bench morton: MortonQuadtree disagrees" << std::endl;
+      return 1;
+    }
+  }
+
+  std::cout << "  found per query:";
+  for (size_t total : expected)
+    std::cout << " " << total / centers.size();
+  std::cout << std::endl;
+  return 0;
+}
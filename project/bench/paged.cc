@@ -0,0 +1,100 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/paged_bplustree.hh"
+#include <cstdio>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// Price searches on a B+ tree kept in a file, with buffer pools from a few
+// pages to the whole tree. Page faults are pages the pool had to read from
+// the file; the operating system's own cache still sits behind it.
+static const char *bench_file = "bench_paged.pages";
+
+int bench_paged(const BenchArgs &args) {
+  if (args.empty()) {
+    std::cerr << "bench paged: expected a data file" << std::endl;
+    return 1;
+  }
+  std::vector<size_t> pools;
+  for (size_t i = 1; i < args.size(); i++)
+    pools.push_back(std::stoul(args[i]));
+  if (pools.empty())
+    pools = {16, 64, 256, 1024, 4096};
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  std::vector<std::pair<float, RowId>> sorted;
+  sorted.reserve(houses.size());
+  for (size_t i = 0; i < houses.size(); i++)
+    sorted.emplace_back(houses[i].price, static_cast<RowId>(i));
+  std::sort(sorted.begin(), sorted.end());
+
+  std::remove(bench_file);
+  {
+    PagedBPlusTree<float, RowId> tree(bench_file, 64);
+    double seconds = time_seconds([&] { tree.bulkLoad(sorted); });
+    tree.flush();
+    std::cout << houses.size() << " rows in " << tree.pageCount()
+              << " pages of " << page_size << " bytes (order "
+              << tree.getOrder() << ", height " << tree.height()
+              << "), bulk load " << std::fixed << std::setprecision(3)
+              << seconds << " s" << std::endl;
+  }
+
+  const size_t queries = 2000;
+  float low = sorted.front().first, high = sorted.back().first;
+  for (size_t pool : pools) {
+    PagedBPlusTree<float, RowId> tree(bench_file, pool);
+    for (float width : {0.0f, 10000.0f, 1000000.0f}) {
+      std::mt19937 rng(5);
+      std::uniform_real_distribution<float> start(low, high);
+      size_t matches = 0;
+      // One pass to warm the pool, then the measured one.
+      for (size_t i = 0; i < queries; i++) {
+        float min = start(rng);
+        tree.countRange(min, min + width);
+      }
+      tree.resetPoolStats();
+      double seconds = time_seconds([&] {
+        for (size_t i = 0; i < queries; i++) {
+          float min = start(rng);
+          matches += tree.countRange(min, min + width);
+        }
+      });
+      const BufferPool::Stats &stats = tree.poolStats();
+      std::cout << std::fixed << std::setprecision(1) << "  pool "
+                << std::setw(5) << pool << " pages  width " << std::setw(9)
+                << width << "  " << std::setw(8)
+                << double(matches) / queries << " matches  "
+                << std::setw(7) << seconds / queries * 1e6 << " us/query  "
+                << std::setprecision(2) << std::setw(6)
+                << double(stats.misses) / queries << " faults/query  hit rate "
+                << std::setprecision(1) << stats.hit_rate() * 100 << "%"
+                << std::endl;
+    }
+  }
+
+  // Random inserts dirty pages all over the tree, so small pools write back
+  // on almost every eviction.
+  for (size_t pool : {pools.front(), pools.back()}) {
+    std::remove(bench_file);
+    PagedBPlusTree<float, RowId> tree(bench_file, pool);
+    std::vector<std::pair<float, RowId>> shuffled(
+        sorted.begin(), sorted.begin() + std::min<size_t>(sorted.size(), 200000));
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(6));
+    double seconds = time_seconds([&] {
+      for (const auto &kv : shuffled)
+        tree.insert(kv.first, kv.second);
+      tree.flush();
+    });
+    const BufferPool::Stats &stats = tree.poolStats();
+    std::cout << std::fixed << std::setprecision(2) << "  insert "
+              << shuffled.size() << " rows, pool " << pool << " pages: "
+              << seconds << " s, " << stats.misses << " faults, "
+              << stats.writes << " page writes, hit rate "
+              << std::setprecision(1) << stats.hit_rate() * 100 << "%"
+              << std::endl;
+  }
+  std::remove(bench_file);
+  return 0;
+}
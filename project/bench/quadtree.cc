@@ -0,0 +1,91 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/bucket_quadtree.hh"
+#include "structures/quadtree.hh"
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// Quadtree (one item per node) against BucketQuadtree at several bucket
+// sizes, on the file's positions and on the same number of points packed
+// into tight clusters. Items are bare positions, so bytes/item is the
+// structure's own overhead plus 8 bytes of payload.
+template <typename Tree>
+static void run(const char *name, Tree &tree,
+                const std::vector<sf::Vector2f> &points,
+                const std::vector<sf::Vector2f> &centers, float radius) {
+  double build = time_seconds([&] {
+    for (sf::Vector2f p : points)
+      tree.add_item(sf::Vector2f(p));
+  });
+  size_t found = 0;
+  double search = best_of(3, [&] {
+    found = 0;
+    for (sf::Vector2f center : centers)
+      found += tree.find_in_radius(center, radius).size();
+  });
+  QuadtreeStats stats = tree.stats();
+  std::cout << std::fixed << std::setprecision(2) << "  " << std::setw(12)
+            << std::left << name << std::right << " build " << build
+            << " s  " << std::setw(8) << stats.nodes << " nodes  depth "
+            << std::setw(2) << stats.max_depth << "  " << std::setprecision(1)
+            << std::setw(5) << double(stats.bytes) / stats.items
+            << " bytes/item  radius " << radius << ": "
+            << std::setprecision(2) << search / centers.size() * 1e6
+            << " us/query (" << found / centers.size() << " found)"
+            << std::endl;
+}
+
+static void compare(const char *label, const std::vector<sf::Vector2f> &points,
+                    const std::vector<size_t> &buckets) {
+  std::mt19937 rng(7);
+  std::vector<sf::Vector2f> centers;
+  for (int i = 0; i < 1000; i++)
+    centers.push_back(points[rng() % points.size()]);
+
+  std::cout << label << std::endl;
+  for (float radius : {200.0f, 1600.0f}) {
+    {
+      Quadtree<sf::Vector2f> tree;
+      run("one per node", tree, points, centers, radius);
+    }
+    for (size_t bucket : buckets) {
+      BucketQuadtree<sf::Vector2f> tree(bucket);
+      std::string name = "bucket " + std::to_string(bucket);
+      run(name.c_str(), tree, points, centers, radius);
+    }
+  }
+}
+
+int bench_quadtree(const BenchArgs &args) {
+  if (args.empty()) {
+    std::cerr << "bench quadtree: expected a data file" << std::endl;
+    return 1;
+  }
+  std::vector<size_t> buckets;
+  for (size_t i = 1; i < args.size(); i++)
+    buckets.push_back(std::stoul(args[i]));
+  if (buckets.empty())
+    buckets = {1, 4, 16, 64, 256};
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  std::vector<sf::Vector2f> points;
+  points.reserve(houses.size());
+  for (const House &house : houses)
+    points.push_back(house.position);
+  houses = {};
+  compare("file positions", points, buckets);
+
+  // Every point moved into one of 50 clusters a few hundred units wide.
+  std::mt19937 rng(8);
+  std::normal_distribution<float> spread(0.0f, 300.0f);
+  std::vector<sf::Vector2f> hubs;
+  for (int i = 0; i < 50; i++)
+    hubs.push_back(points[rng() % points.size()]);
+  for (sf::Vector2f &p : points) {
+    sf::Vector2f hub = hubs[rng() % hubs.size()];
+    p = {hub.x + spread(rng), hub.y + spread(rng)};
+  }
+  compare("clustered", points, buckets);
+  return 0;
+}
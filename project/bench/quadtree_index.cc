@@ -0,0 +1,84 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/quadtree.hh"
+#include "structures/quadtree_index.hh"
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+// Indexing the loaded houses: Quadtree<House> fed one heap copy at a time
+// through add_item, against QuadtreeIndex built over the vector in place,
+// serially and on every hardware thread. Bytes count the index, including
+// the copies Quadtree makes, but not the loaded vector itself.
+template <typename Tree>
+static void report(const std::string &name, double build, Tree &tree,
+                   const std::vector<sf::Vector2f> &centers,
+                   std::vector<size_t> &found) {
+  QuadtreeStats stats = tree.stats();
+  std::cout << std::fixed << std::setprecision(2) << "  " << std::setw(17)
+            << std::left << name << std::right << " build " << std::setw(6)
+            << build << " s  " << std::setw(8) << stats.nodes
+            << " nodes  depth " << std::setw(2) << stats.max_depth << "  "
+            << std::setprecision(1) << std::setw(6)
+            << double(stats.bytes) / stats.items << " bytes/item ";
+  found.clear();
+  for (float radius : {200.0f, 1600.0f}) {
+    size_t total = 0;
+    double search = best_of(3, [&] {
+      total = 0;
+      for (sf::Vector2f center : centers)
+        total += tree.find_in_radius(center, radius).size();
+    });
+    found.push_back(total);
+    std::cout << " r" << int(radius) << " " << std::setprecision(2)
+              << std::setw(7) << search / centers.size() * 1e6 << " us";
+  }
+  std::cout << std::endl;
+}
+
+int bench_quadtree_index(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench quadtree-index: expected a data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  if (houses.empty()) {
+    std::cerr << "bench quadtree-index: no houses" << std::endl;
+    return 1;
+  }
+  std::mt19937 rng(25);
+  std::vector<sf::Vector2f> centers;
+  for (int i = 0; i < 1000; i++)
+    centers.push_back(houses[rng() % houses.size()].position);
+  std::cout << houses.size() << " houses, "
+            << std::thread::hardware_concurrency() << " hardware threads"
+            << std::endl;
+
+  std::vector<size_t> expected, found;
+  {
+    Quadtree<House> tree;
+    double build = time_seconds([&] {
+      for (const House &house : houses)
+        tree.add_item(std::make_unique<House>(house));
+    });
+    report("quadtree copies", build, tree, centers, expected);
+  }
+  for (unsigned int threads : {1u, 0u}) {
+    std::unique_ptr<QuadtreeIndex<House>> index;
+    double build = best_of(3, [&] {
+      index = std::make_unique<QuadtreeIndex<House>>(houses, 16, threads);
+    });
+    report(threads == 1 ? "index 1 thread" : "index all threads", build,
+           *index, centers, found);
+    if (found != expected) {
+      std::cerr << "bench quadtree-index: QuadtreeIndex disagrees"
+                << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,55 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/redblack.hh"
+#include <iomanip>
+#include <iostream>
+
+// What the app needs for one page of results (the match count and four
+// houses), from price_range against count_in_range + select_in_range.
+int bench_rb_rank(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench rb-rank: expected a data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  RedBlackTree tree;
+  for (size_t i = 0; i < houses.size(); i++)
+    tree.insert(houses[i].price, static_cast<RowId>(i));
+  std::cout << houses.size() << " rows" << std::endl;
+
+  const size_t per_page = 4;
+  for (float width : {10000.0f, 100000.0f, 1000000.0f, 10000000.0f}) {
+    float min = 1000000, max = min + width;
+    size_t page = 0;
+
+    size_t eager_count = 0;
+    double eager = best_of(3, [&] {
+      auto matches = tree.price_range(min, max);
+      eager_count = matches.size();
+      page = eager_count / per_page / 2;
+    });
+
+    size_t counted = 0;
+    RowId *first = nullptr;
+    double ranked = best_of(3, [&] {
+      counted = tree.count_in_range(min, max);
+      for (size_t i = 0; i < per_page; i++) {
+        RowId *row = tree.select_in_range(min, max, page * per_page + i);
+        if (i == 0)
+          first = row;
+      }
+    });
+
+    if (counted != eager_count ||
+        (counted && first != tree.price_range(min, max)[page * per_page])) {
+      std::cerr << "bench rb-rank: the two ways disagree" << std::endl;
+      return 1;
+    }
+    std::cout << "  " << std::setw(9) << counted << " matches  price_range "
+              << std::fixed << std::setprecision(1) << std::setw(9)
+              << eager * 1e6 << " us  count+select " << std::setw(6)
+              << ranked * 1e6 << " us" << std::endl;
+  }
+  return 0;
+}
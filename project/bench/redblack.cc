@@ -0,0 +1,54 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/redblack.hh"
+#include <algorithm>
+#include <utility>
+#include <iomanip>
+#include <iostream>
+
+// Per-row insert vs sort + linear-time build.
+int bench_rb_build(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench rb-build: expected a data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  std::cout << houses.size() << " rows" << std::endl;
+
+  size_t inserted_matches = 0;
+  double insert_time = best_of(3, [&] {
+    RedBlackTree tree;
+    for (size_t i = 0; i < houses.size(); i++)
+      tree.insert(houses[i].price, static_cast<RowId>(i));
+    inserted_matches = tree.price_range(1000000, 2000000).size();
+  });
+
+  size_t built_matches = 0;
+  double build_time = best_of(3, [&] {
+    std::vector<std::pair<float, RowId>> sorted;
+    sorted.reserve(houses.size());
+    for (size_t i = 0; i < houses.size(); i++)
+      sorted.push_back({houses[i].price, static_cast<RowId>(i)});
+    std::stable_sort(sorted.begin(), sorted.end(),
+                     [](const auto &a, const auto &b) {
+                       return a.first < b.first;
+                     });
+    RedBlackTree tree;
+    tree.build_from_sorted(sorted);
+    built_matches = tree.price_range(1000000, 2000000).size();
+  });
+
+  if (inserted_matches != built_matches) {
+    std::cerr << "bench rb-build: trees disagree (" << inserted_matches
+              << " vs " << built_matches << ")" << std::endl;
+    return 1;
+  }
+
+  std::cout << std::fixed << std::setprecision(3) << "  insert     "
+            << insert_time << " s\n"
+            << "  sort+build " << build_time << " s ("
+            << std::setprecision(2) << insert_time / build_time << "x)"
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/flat_bplustree.hh"
+#include "structures/redblack.hh"
+#include "structures/versioned_bplustree.hh"
+#include <atomic>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+
+// Page-fetch latency while the second half of a file streams in, the way
+// Ingest indexes it: in 8192-row batches. The flat tree shares a mutex with
+// its writer, as every index in Ingest used to; the versioned tree's readers
+// load the last published version and never wait. The red-black tree still
+// shares a mutex, held either for a whole batch or for short chunks of it.
+static const size_t ingest_batch = 8192;
+static const size_t rb_lock_rows = 256;
+
+struct Latencies {
+  std::vector<double> us;
+
+  void print(const char *name, double write_seconds, size_t written) const {
+    std::vector<double> sorted = us;
+    std::sort(sorted.begin(), sorted.end());
+    auto at = [&](double q) {
+      return sorted.empty() ? 0.0 : sorted[size_t(q * (sorted.size() - 1))];
+    };
+    std::cout << std::fixed << std::setprecision(1) << "  " << std::setw(22)
+              << std::left << name << std::right << std::setw(8)
+              << sorted.size() << " queries  p50 " << at(0.5) << " us  p99 "
+              << at(0.99) << " us  p99.9 " << at(0.999) << " us  max " << at(1.0) << " us";
+    if (written)
+      std::cout << "  writer " << std::setprecision(2)
+                << written / write_seconds / 1e6 << " M rows/s";
+    std::cout << std::endl;
+  }
+};
+
+// Runs `query` on a second thread until `write` returns, or `queries` times
+// when there is nothing to write.
+template <typename Query, typename Write>
+static Latencies measure(Query &&query, Write &&write, size_t queries,
+                  double &write_seconds) {
+  Latencies result;
+  std::atomic<bool> writing{true};
+  std::thread reader([&] {
+    std::mt19937 rng(3);
+    while (queries ? result.us.size() < queries : writing.load()) {
+      float min = float(rng() % 2000000);
+      result.us.push_back(time_seconds([&] { query(min); }) * 1e6);
+    }
+  });
+  write_seconds = time_seconds(write);
+  writing = false;
+  reader.join();
+  return result;
+}
+
+int bench_snapshots(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench snapshots: expected a data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  size_t half = houses.size() / 2;
+  std::cout << houses.size() << " rows, half indexed up front" << std::endl;
+
+  // Page 10 of four matches, as Ingest::search_page fetches it.
+  const size_t skip = 40, per_page = 4;
+  const float width = 100000;
+  size_t sink = 0;
+
+  FlatBPlusTree<float, RowId, 21> flat;
+  std::mutex mutex;
+  for (size_t i = 0; i < half; i++)
+    flat.insert(houses[i].price, static_cast<RowId>(i));
+  auto flat_query = [&](float min) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto cursor = flat.range(min, min + width);
+    cursor.skip(skip);
+    for (size_t i = 0; i < per_page; i++)
+      sink += cursor.next() != nullptr;
+  };
+  auto flat_write = [&] {
+    for (size_t first = half; first < houses.size(); first += ingest_batch) {
+      std::lock_guard<std::mutex> lock(mutex);
+      size_t last = std::min(houses.size(), first + ingest_batch);
+      for (size_t i = first; i < last; i++)
+        flat.insert(houses[i].price, static_cast<RowId>(i));
+    }
+  };
+
+  VersionedBPlusTree<float, RowId, 21> versioned;
+  for (size_t i = 0; i < half; i++)
+    versioned.insert(houses[i].price, static_cast<RowId>(i));
+  versioned.publish();
+  auto versioned_query = [&](float min) {
+    auto cursor = versioned.snapshot().range(min, min + width, skip);
+    for (size_t i = 0; i < per_page; i++)
+      sink += cursor.next() != nullptr;
+  };
+  auto versioned_write = [&] {
+    for (size_t first = half; first < houses.size(); first += ingest_batch) {
+      size_t last = std::min(houses.size(), first + ingest_batch);
+      for (size_t i = first; i < last; i++)
+        versioned.insert(houses[i].price, static_cast<RowId>(i));
+      versioned.publish();
+    }
+  };
+
+  RedBlackTree rbtree;
+  for (size_t i = 0; i < half; i++)
+    rbtree.insert(houses[i].price, static_cast<RowId>(i));
+  auto rb_query = [&](float min) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = skip; i < skip + per_page; i++)
+      sink += rbtree.select_in_range(min, min + width, i) != nullptr;
+  };
+  // Inserts the second half, taking the lock for `chunk` rows at a time.
+  auto rb_write = [&](size_t chunk) {
+    return [&, chunk] {
+      for (size_t first = half; first < houses.size(); first += chunk) {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t last = std::min(houses.size(), first + chunk);
+        for (size_t i = first; i < last; i++)
+          rbtree.insert(houses[i].price, static_cast<RowId>(i));
+      }
+    };
+  };
+
+  double seconds = 0;
+  auto idle = [] {};
+  measure(flat_query, idle, 20000, seconds).print("flat, no writer", 0, 0);
+  measure(versioned_query, idle, 20000, seconds)
+      .print("versioned, no writer", 0, 0);
+  Latencies locked = measure(flat_query, flat_write, 0, seconds);
+  locked.print("flat + mutex, writing", seconds, houses.size() - half);
+  Latencies lock_free = measure(versioned_query, versioned_write, 0, seconds);
+  lock_free.print("versioned, writing", seconds, houses.size() - half);
+
+  // Both writers add the same rows, so each starts from the first half.
+  measure(rb_query, idle, 20000, seconds).print("rb, no writer", 0, 0);
+  measure(rb_query, rb_write(ingest_batch), 0, seconds)
+      .print("rb, batch lock", seconds, houses.size() - half);
+  rbtree.clear();
+  for (size_t i = 0; i < half; i++)
+    rbtree.insert(houses[i].price, static_cast<RowId>(i));
+  measure(rb_query, rb_write(rb_lock_rows), 0, seconds)
+      .print("rb, 256-row locks", seconds, houses.size() - half);
+
+  if (flat.countRange(0, 1e12f) != versioned.snapshot().size() ||
+      rbtree.count_in_range(0, 1e12f) != houses.size()) {
+    std::cerr << "bench snapshots: the trees disagree" << std::endl;
+    return 1;
+  }
+  return sink == 0;
+}
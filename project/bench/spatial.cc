@@ -0,0 +1,113 @@
+#include "bench.hh"
+#include "lib.hh"
+#include "structures/quadtree.hh"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// Map view queries on the file's positions: viewport boxes with
+// Quadtree::find_in_rect and "closest listings" with find_k_nearest, each
+// against a scan over every point.
+int bench_spatial(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench spatial: expected a data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  std::vector<sf::Vector2f> points;
+  points.reserve(houses.size());
+  for (const House &house : houses)
+    points.push_back(house.position);
+  houses = {};
+
+  Quadtree<sf::Vector2f> tree;
+  double build = time_seconds([&] {
+    for (sf::Vector2f p : points)
+      tree.add_item(std::make_unique<sf::Vector2f>(p));
+  });
+  float min_x = points[0].x, max_x = min_x, min_y = points[0].y, max_y = min_y;
+  for (sf::Vector2f p : points) {
+    min_x = std::min(min_x, p.x);
+    max_x = std::max(max_x, p.x);
+    min_y = std::min(min_y, p.y);
+    max_y = std::max(max_y, p.y);
+  }
+  std::cout << points.size() << " points, built in " << std::fixed
+            << std::setprecision(2) << build << " s" << std::endl;
+
+  std::mt19937 rng(9);
+  std::uniform_real_distribution<float> x_dist(min_x, max_x);
+  std::uniform_real_distribution<float> y_dist(min_y, max_y);
+  const int queries = 100;
+  auto report = [&](const std::string &name, size_t found, double tree_s,
+                    double scan_s) {
+    std::cout << std::fixed << std::setprecision(1) << "  " << std::setw(18)
+              << std::left << name << std::right << std::setw(8)
+              << double(found) / queries << " found  quadtree "
+              << std::setw(8) << tree_s / queries * 1e6 << " us  scan "
+              << std::setw(8) << scan_s / queries * 1e6 << " us  ("
+              << scan_s / tree_s << "x)" << std::endl;
+  };
+
+  for (float size : {500.0f, 2000.0f, 8000.0f}) {
+    std::vector<sf::Vector2f> corners;
+    for (int i = 0; i < queries; i++)
+      corners.push_back({x_dist(rng), y_dist(rng)});
+    size_t found = 0, scanned = 0;
+    double tree_s = best_of(3, [&] {
+      found = 0;
+      for (sf::Vector2f c : corners)
+        found += tree.find_in_rect(c.x, c.x + size, c.y, c.y + size).size();
+    });
+    double scan_s = best_of(3, [&] {
+      scanned = 0;
+      for (sf::Vector2f c : corners) {
+        std::vector<const sf::Vector2f *> inside;
+        for (const sf::Vector2f &p : points) {
+          if (p.x >= c.x && p.x <= c.x + size && p.y >= c.y &&
+              p.y <= c.y + size)
+            inside.push_back(&p);
+        }
+        scanned += inside.size();
+      }
+    });
+    if (found != scanned) {
+      std::cerr << "bench spatial: find_in_rect disagrees with the scan"
+                << std::endl;
+      return 1;
+    }
+    report("rect " + std::to_string(int(size)), found, tree_s, scan_s);
+  }
+
+  for (size_t k : {1, 10, 100}) {
+    std::vector<sf::Vector2f> centers;
+    for (int i = 0; i < queries; i++)
+      centers.push_back({x_dist(rng), y_dist(rng)});
+    float tree_far = 0, scan_far = 0;
+    double tree_s = best_of(3, [&] {
+      tree_far = 0;
+      for (sf::Vector2f c : centers)
+        tree_far += (*tree.find_k_nearest(c, k).back() - c).lengthSquared();
+    });
+    double scan_s = best_of(3, [&] {
+      scan_far = 0;
+      std::vector<float> distances(points.size());
+      for (sf::Vector2f c : centers) {
+        for (size_t i = 0; i < points.size(); i++)
+          distances[i] = (points[i] - c).lengthSquared();
+        std::nth_element(distances.begin(), distances.begin() + (k - 1),
+                         distances.end());
+        scan_far += distances[k - 1];
+      }
+    });
+    if (tree_far != scan_far) {
+      std::cerr << "bench spatial: find_k_nearest disagrees with the scan"
+                << std::endl;
+      return 1;
+    }
+    report("nearest " + std::to_string(k), k * queries, tree_s, scan_s);
+  }
+  return 0;
+}
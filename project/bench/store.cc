@@ -0,0 +1,105 @@
+#include "bench.hh"
+#include "house_store.hh"
+#include "lib.hh"
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// Price-range filters over the array-of-structs dataset and over the price
+// column of a HouseStore, then the same with a "Pool + Fireplace" feature
+// filter (substring search vs the mask column).
+int bench_store(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench store: expected one data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  HouseStore store(houses);
+  if (houses.empty()) {
+    std::cerr << "bench store: no rows in " << args[0] << std::endl;
+    return 1;
+  }
+
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<float> price_dist(400000, 3000000);
+  std::vector<std::pair<float, float>> ranges;
+  for (int i = 0; i < 20; i++) {
+    float a = price_dist(gen);
+    float b = price_dist(gen);
+    ranges.emplace_back(std::min(a, b), std::max(a, b));
+  }
+
+  size_t aos_matches = 0;
+  double aos = best_of(3, [&] {
+    aos_matches = 0;
+    for (auto [min, max] : ranges) {
+      std::vector<RowId> result;
+      for (size_t i = 0; i < houses.size(); i++) {
+        if (min <= houses[i].price && houses[i].price <= max)
+          result.push_back(static_cast<RowId>(i));
+      }
+      aos_matches += result.size();
+    }
+  });
+
+  size_t soa_matches = 0;
+  double soa = best_of(3, [&] {
+    soa_matches = 0;
+    for (auto [min, max] : ranges)
+      soa_matches += store.price_range(min, max).size();
+  });
+
+  if (aos_matches != soa_matches) {
+    std::cerr << "bench store: scans disagree (" << aos_matches << " vs "
+              << soa_matches << ")" << std::endl;
+    return 1;
+  }
+
+  FeatureMask wanted = feature_bit("Pool") | feature_bit("Fireplace");
+  size_t aos_feature_matches = 0;
+  double aos_features = best_of(3, [&] {
+    aos_feature_matches = 0;
+    for (auto [min, max] : ranges) {
+      std::vector<RowId> result;
+      for (size_t i = 0; i < houses.size(); i++) {
+        const House &h = houses[i];
+        if (min <= h.price && h.price <= max &&
+            h.features.find("Pool") != std::string::npos &&
+            h.features.find("Fireplace") != std::string::npos) {
+          result.push_back(static_cast<RowId>(i));
+        }
+      }
+      aos_feature_matches += result.size();
+    }
+  });
+
+  size_t soa_feature_matches = 0;
+  double soa_features = best_of(3, [&] {
+    soa_feature_matches = 0;
+    for (auto [min, max] : ranges)
+      soa_feature_matches += store.price_range(min, max, wanted).size();
+  });
+
+  if (aos_feature_matches != soa_feature_matches) {
+    std::cerr << "bench store: feature scans disagree (" << aos_feature_matches
+              << " vs " << soa_feature_matches << ")" << std::endl;
+    return 1;
+  }
+
+  double rows_scanned = static_cast<double>(houses.size()) * ranges.size();
+  auto report = [&](const char *name, double seconds, double baseline) {
+    std::cout << "  " << std::left << std::setw(28) << name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(8)
+              << seconds * 1e9 / rows_scanned << " ns/row "
+              << std::setprecision(2) << std::setw(6) << baseline / seconds
+              << "x" << std::endl;
+  };
+  std::cout << houses.size() << " rows, " << ranges.size() << " price ranges"
+            << std::endl;
+  report("vector<House> price", aos, aos);
+  report("HouseStore price", soa, aos);
+  report("vector<House> price+features", aos_features, aos_features);
+  report("HouseStore price+features", soa_features, aos_features);
+  return 0;
+}
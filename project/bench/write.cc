@@ -0,0 +1,56 @@
+#include "bench.hh"
+#include "io/house_writer.hh"
+#include "lib.hh"
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// Writing a dataset back out: operator<< per row vs buffered to_chars blocks.
+int bench_write(const BenchArgs &args) {
+  if (args.size() != 1) {
+    std::cerr << "bench write: expected a data file" << std::endl;
+    return 1;
+  }
+
+  std::vector<House> houses = load_file(args[0], LoadMode::Parallel);
+  std::string out = args[0] + ".written";
+  std::cout << houses.size() << " rows" << std::endl;
+
+  double stream_time = best_of(3, [&] {
+    std::ofstream file(out, std::ios::binary);
+    for (const House &h : houses)
+      file << h;
+  });
+
+  double buffered_time = best_of(3, [&] {
+    std::ofstream file(out, std::ios::binary);
+    write_houses(file, houses);
+  });
+
+  double threaded_time = best_of(3, [&] {
+    std::ofstream file(out, std::ios::binary);
+    write_houses(file, houses, 0);
+  });
+
+  // The output must still load back to the same number of rows.
+  size_t reloaded = load_file(out, LoadMode::Mapped).size();
+  std::remove(out.c_str());
+  if (reloaded != houses.size()) {
+    std::cerr << "bench write: wrote " << reloaded << " rows back, expected "
+              << houses.size() << std::endl;
+    return 1;
+  }
+
+  auto report = [&](const char *name, double seconds) {
+    std::cout << "  " << std::left << std::setw(20) << name << std::right
+              << std::fixed << std::setprecision(3) << std::setw(8) << seconds
+              << " s " << std::setw(12) << std::setprecision(0)
+              << houses.size() / seconds << " rows/s " << std::setprecision(2)
+              << std::setw(6) << stream_time / seconds << "x" << std::endl;
+  };
+  report("operator<<", stream_time);
+  report("write_houses", buffered_time);
+  report("write_houses (all)", threaded_time);
+  return 0;
+}
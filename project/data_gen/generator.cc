@@ -0,0 +1,240 @@
+#include "generator.hh"
+#include "features.hh"
+#include "structures/quadtree.hh"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+
+namespace {
+
+const std::string cardinality = "se";
+constexpr float min_price = 400000;
+constexpr float max_price = 3000000;
+
+// What neighbouring tiles need to know about a generated house.
+struct PricePoint {
+  sf::Vector2f position;
+  float price;
+};
+
+// Prices are summed over radius searches, so the trees keep price totals.
+struct PriceOf {
+  float operator()(const PricePoint &p) const { return p.price; }
+};
+using PriceTree = Quadtree<PricePoint, PriceOf>;
+
+struct Tile {
+  float left, right, top, bottom;
+  size_t count;
+  std::unique_ptr<PriceTree> prices;
+  std::vector<House> houses;
+};
+
+} // namespace
+
+template <> inline sf::Vector2f get_position<PricePoint>(const PricePoint &p) {
+  return p.position;
+}
+
+namespace {
+
+// Everything but the position and price, drawn the same way the original
+// sequential generator did.
+House make_house(std::mt19937_64 &gen, sf::Vector2f pos, float price) {
+  float x = pos.x;
+  float y = pos.y;
+
+  // Address Generation
+  bool is_street = gen() % 2;
+
+  std::string house_num;
+  std::string road_num;
+  if (is_street) {
+    house_num = std::to_string(static_cast<int>(x / 2));
+    road_num = std::to_string(static_cast<int>(y / 200));
+  } else {
+    house_num = std::to_string(static_cast<int>(y / 2));
+    road_num = std::to_string(static_cast<int>(x / 200));
+  }
+
+  std::string suffix;
+  char final_digit = road_num.back();
+  switch (final_digit) {
+  case '1':
+    suffix = "st";
+    break;
+  case '2':
+    suffix = "nd";
+    break;
+  case '3':
+    suffix = "rd";
+    break;
+  default:
+    suffix = "th";
+    break;
+  }
+  road_num = road_num + suffix;
+
+  float base_area = price * 0.000175;
+  std::uniform_real_distribution<float> area_dist(base_area - 100,
+                                                  base_area + 100);
+  float area = area_dist(gen);
+  if (area < 50) {
+    area = 50;
+  }
+
+  int base_roomcount = static_cast<int>(price / 330000);
+  std::uniform_int_distribution<int> room_dist(base_roomcount - 2,
+                                               base_roomcount + 2);
+  int roomcount = room_dist(gen);
+  if (roomcount < 1) {
+    roomcount = 1;
+  }
+
+  int bathroom_center = roomcount / 2;
+  int bathroom_delta = roomcount / 2;
+  std::uniform_int_distribution<int> dist(0, bathroom_delta * 2);
+  int bathcount = bathroom_center + (dist(gen) - dist(gen));
+  if (bathcount < 1)
+    bathcount = 1;
+  if (bathcount > roomcount)
+    bathcount = roomcount;
+
+  std::uniform_int_distribution<int> num_features_dist(1, 3);
+  size_t num_features = num_features_dist(gen);
+
+  std::vector<int> indices;
+  for (size_t i = 0; i < feature_count; i++) {
+    indices.push_back(i);
+  }
+
+  std::shuffle(indices.begin(), indices.end(), gen);
+  std::string features_str;
+  for (size_t i = 0; i < num_features; i++) {
+    features_str += feature_names[indices[i]];
+    if (i < num_features - 1) {
+      features_str += ", ";
+    }
+  }
+
+  Address address{house_num, cardinality, road_num, is_street ? "st" : "ave"};
+
+  return House{address,
+               pos,
+               price,
+               area,
+               static_cast<unsigned int>(roomcount),
+               static_cast<unsigned int>(bathcount),
+               features_str};
+}
+
+// Uniform in [low, high). The float distribution can round up to high.
+float draw_in(std::mt19937_64 &gen, float low, float high) {
+  float value = std::uniform_real_distribution<float>(low, high)(gen);
+  return value < high ? value : std::nextafter(high, low);
+}
+
+} // namespace
+
+void generate_houses(const GeneratorOptions &options,
+                     const std::function<void(std::vector<House> &&)> &emit) {
+  // Tiles at least as wide as the radius, so every neighbour of a house lies
+  // in its own tile or one of the eight around it.
+  size_t columns = std::max<size_t>(
+      1, static_cast<size_t>(options.width / neighbour_radius));
+  size_t rows = std::max<size_t>(
+      1, static_cast<size_t>(options.height / neighbour_radius));
+  float tile_width = options.width / columns;
+  float tile_height = options.height / rows;
+
+  std::vector<Tile> tiles(columns * rows);
+  for (size_t row = 0; row < rows; row++) {
+    for (size_t column = 0; column < columns; column++) {
+      size_t index = row * columns + column;
+      Tile &tile = tiles[index];
+      tile.left = column * tile_width;
+      tile.right = column + 1 == columns ? options.width
+                                         : (column + 1) * tile_width;
+      tile.top = row * tile_height;
+      tile.bottom = row + 1 == rows ? options.height : (row + 1) * tile_height;
+      // Equal-area tiles get an equal share, so density stays uniform.
+      tile.count = options.count / tiles.size() +
+                   (index < options.count % tiles.size() ? 1 : 0);
+      tile.prices = std::make_unique<PriceTree>(
+          tile.left, tile.right, tile.top, tile.bottom);
+    }
+  }
+
+  auto generate_tile = [&](size_t index) {
+    Tile &tile = tiles[index];
+    size_t column = index % columns;
+    size_t row = index / columns;
+
+    std::seed_seq seq{static_cast<std::uint32_t>(options.seed),
+                      static_cast<std::uint32_t>(options.seed >> 32),
+                      static_cast<std::uint32_t>(index),
+                      static_cast<std::uint32_t>(index >> 32)};
+    std::mt19937_64 gen(seq);
+    std::uniform_real_distribution<float> price_dist(min_price, max_price);
+
+    // The halo: this tile and the eight around it. Tiles of later phases are
+    // still empty, tiles of earlier phases are finished and read-only.
+    std::vector<PriceTree *> halo;
+    for (size_t r = row ? row - 1 : 0; r <= std::min(row + 1, rows - 1); r++) {
+      for (size_t c = column ? column - 1 : 0;
+           c <= std::min(column + 1, columns - 1); c++) {
+        halo.push_back(tiles[r * columns + c].prices.get());
+      }
+    }
+
+    tile.houses.reserve(tile.count);
+    for (size_t i = 0; i < tile.count; i++) {
+      // Position generation
+      sf::Vector2f pos{draw_in(gen, tile.left, tile.right),
+                       draw_in(gen, tile.top, tile.bottom)};
+
+      // Price Generation
+      QuadtreeAggregate near;
+      for (PriceTree *tree : halo)
+        near.add(tree->aggregate_in_radius(pos, neighbour_radius));
+      float price = static_cast<float>((price_dist(gen) * 5.0 + near.sum) /
+                                       (near.count + 5));
+
+      tile.houses.push_back(make_house(gen, pos, price));
+      tile.prices->add_item(PricePoint{pos, price});
+    }
+  };
+
+  unsigned int threads = options.threads;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (size_t phase = 0; phase < 4; phase++) {
+    std::vector<size_t> phase_tiles;
+    for (size_t index = 0; index < tiles.size(); index++) {
+      if ((index % columns) % 2 * 2 + (index / columns) % 2 == phase)
+        phase_tiles.push_back(index);
+    }
+
+    std::atomic<size_t> next{0};
+    auto work = [&] {
+      for (size_t i = next++; i < phase_tiles.size(); i = next++)
+        generate_tile(phase_tiles[i]);
+    };
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threads && t < phase_tiles.size(); t++)
+      workers.emplace_back(work);
+    work();
+    for (std::thread &worker : workers)
+      worker.join();
+
+    for (size_t index : phase_tiles) {
+      emit(std::move(tiles[index].houses));
+      tiles[index].houses = {};
+    }
+  }
+}
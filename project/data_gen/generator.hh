@@ -0,0 +1,31 @@
+#pragma once
+#include "lib.hh"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct GeneratorOptions {
+  size_t count = 100000;
+  std::uint64_t seed = 0;
+  float width = 40000;
+  float height = 40000;
+  // 0 uses one thread per hardware thread.
+  unsigned int threads = 0;
+};
+
+// A house's price is averaged with every earlier house within this distance.
+constexpr float neighbour_radius = 1600;
+
+// Generates options.count houses and hands them to `emit` in batches, always
+// on the calling thread.
+//
+// The world is cut into tiles at least neighbour_radius wide, and every tile
+// draws from its own generator seeded from (seed, tile). Tiles are processed
+// in four phases by the parity of their column and row: two tiles in the same
+// phase are never neighbours, so they can be generated in parallel while
+// reading the finished tiles around them (the halo) for neighbour prices.
+// Batches are emitted phase by phase, in tile order, so the output only
+// depends on the options, not on the thread count or scheduling.
+void generate_houses(const GeneratorOptions &options,
+                     const std::function<void(std::vector<House> &&)> &emit);
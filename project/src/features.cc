@@ -0,0 +1,42 @@
+#include "features.hh"
+
+static std::string_view trim(std::string_view text) {
+  while (!text.empty() && (text.front() == ' ' || text.front() == '\t'))
+    text.remove_prefix(1);
+  while (!text.empty() && (text.back() == ' ' || text.back() == '\t' ||
+                           text.back() == '\r'))
+    text.remove_suffix(1);
+  return text;
+}
+
+FeatureMask feature_bit(std::string_view name) {
+  for (std::size_t i = 0; i < feature_count; i++) {
+    if (feature_names[i] == name)
+      return static_cast<FeatureMask>(1u << i);
+  }
+  return 0;
+}
+
+FeatureMask parse_features(std::string_view features) {
+  FeatureMask mask = 0;
+  while (!features.empty()) {
+    std::size_t comma = features.find(',');
+    mask |= feature_bit(trim(features.substr(0, comma)));
+    if (comma == std::string_view::npos)
+      break;
+    features.remove_prefix(comma + 1);
+  }
+  return mask;
+}
+
+std::string features_to_string(FeatureMask mask) {
+  std::string result;
+  for (std::size_t i = 0; i < feature_count; i++) {
+    if (mask & (1u << i)) {
+      if (!result.empty())
+        result += ", ";
+      result += feature_names[i];
+    }
+  }
+  return result;
+}
@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// One bit per entry of feature_names.
+using FeatureMask = std::uint16_t;
+
+// Every feature datagen can produce, in bit order.
+inline constexpr std::string_view feature_names[] = {
+    "Large Kitchen",     "Pool",
+    "Master Suite",      "Home Office",
+    "Finished Basement", "Hardwood Floors",
+    "Gourmet Kitchen",   "High Ceilings",
+    "Walk-in Closet",    "Fireplace"};
+
+inline constexpr std::size_t feature_count =
+    sizeof(feature_names) / sizeof(feature_names[0]);
+static_assert(feature_count <= sizeof(FeatureMask) * 8,
+              "FeatureMask is too narrow for feature_names");
+
+// Bit for a feature name, or 0 if the name is unknown.
+FeatureMask feature_bit(std::string_view name);
+
+// Mask of a comma separated feature list such as "Pool, Fireplace". Unknown
+// names are ignored.
+FeatureMask parse_features(std::string_view features);
+
+// Comma separated names of every bit in mask, in bit order.
+std::string features_to_string(FeatureMask mask);
@@ -0,0 +1,150 @@
+#include "house_store.hh"
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define HOUSE_STORE_SSE2 1
+#endif
+
+HouseStore::HouseStore(const std::vector<House> &houses) {
+  reserve(houses.size());
+  for (const House &h : houses)
+    add(h);
+}
+
+HouseStore::HouseStore(SnapshotColumns &&columns)
+    : xs(std::move(columns.x)), ys(std::move(columns.y)),
+      prices(std::move(columns.price)), areas(std::move(columns.area)),
+      room_counts(std::move(columns.room_count)),
+      bathroom_counts(std::move(columns.bathroom_count)),
+      string_offsets(std::move(columns.string_offsets)),
+      string_heap(std::move(columns.string_heap)) {
+  if (prices.size() > std::numeric_limits<RowId>::max())
+    throw std::length_error("HouseStore: too many rows for a 32-bit RowId");
+  if (string_offsets.empty())
+    string_offsets.push_back(0);
+
+  feature_masks.reserve(prices.size());
+  for (RowId row = 0; row < prices.size(); row++)
+    feature_masks.push_back(parse_features(features(row)));
+}
+
+void HouseStore::reserve(std::size_t rows, std::size_t heap_bytes) {
+  xs.reserve(rows);
+  ys.reserve(rows);
+  prices.reserve(rows);
+  areas.reserve(rows);
+  room_counts.reserve(rows);
+  bathroom_counts.reserve(rows);
+  feature_masks.reserve(rows);
+  string_offsets.reserve(rows * strings_per_row + 1);
+  string_heap.reserve(heap_bytes);
+}
+
+RowId HouseStore::add(const House &house) {
+  if (size() >= std::numeric_limits<RowId>::max())
+    throw std::length_error("HouseStore: too many rows for a 32-bit RowId");
+
+  RowId id = static_cast<RowId>(size());
+  xs.push_back(house.position.x);
+  ys.push_back(house.position.y);
+  prices.push_back(house.price);
+  areas.push_back(house.area);
+  room_counts.push_back(house.room_count);
+  bathroom_counts.push_back(house.bathroom_count);
+  feature_masks.push_back(parse_features(house.features));
+  for (const std::string *s :
+       {&house.address.house_number, &house.address.cardinal,
+        &house.address.road_number, &house.address.road_type,
+        &house.features}) {
+    string_heap += *s;
+    string_offsets.push_back(string_heap.size());
+  }
+  return id;
+}
+
+std::string_view HouseStore::string_at(RowId row, std::size_t field) const {
+  std::size_t index = row * strings_per_row + field;
+  return std::string_view(string_heap.data() + string_offsets[index],
+                          string_offsets[index + 1] - string_offsets[index]);
+}
+
+Address HouseStore::address(RowId row) const {
+  return Address{std::string(house_number(row)), std::string(cardinal(row)),
+                 std::string(road_number(row)), std::string(road_type(row))};
+}
+
+House HouseStore::house(RowId row) const {
+  return House{address(row),        position(row),
+               price(row),          area(row),
+               room_count(row),     bathroom_count(row),
+               std::string(features(row))};
+}
+
+std::vector<RowId> HouseStore::price_range(float min, float max,
+                                           FeatureMask required) const {
+  std::vector<RowId> result;
+  const float *price_column = prices.data();
+  const FeatureMask *mask_column = feature_masks.data();
+  std::size_t i = 0;
+
+#ifdef HOUSE_STORE_SSE2
+  // Eight rows per step: two 4-wide float compares on the prices, narrowed to
+  // 16-bit lanes so they line up with the eight masks.
+  const __m128 low = _mm_set1_ps(min);
+  const __m128 high = _mm_set1_ps(max);
+  const __m128i wanted = _mm_set1_epi16(static_cast<short>(required));
+  for (; i + 8 <= prices.size(); i += 8) {
+    __m128 p0 = _mm_loadu_ps(price_column + i);
+    __m128 p1 = _mm_loadu_ps(price_column + i + 4);
+    __m128 in0 = _mm_and_ps(_mm_cmple_ps(low, p0), _mm_cmple_ps(p0, high));
+    __m128 in1 = _mm_and_ps(_mm_cmple_ps(low, p1), _mm_cmple_ps(p1, high));
+    __m128i in_range =
+        _mm_packs_epi32(_mm_castps_si128(in0), _mm_castps_si128(in1));
+
+    __m128i masks = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(mask_column + i));
+    __m128i has_features =
+        _mm_cmpeq_epi16(_mm_and_si128(masks, wanted), wanted);
+
+    // Two bits per 16-bit lane; look at the low one of each.
+    int hits = _mm_movemask_epi8(_mm_and_si128(in_range, has_features));
+    for (int lane = 0; hits != 0; lane++, hits >>= 2) {
+      if (hits & 1)
+        result.push_back(static_cast<RowId>(i + lane));
+    }
+  }
+#endif
+
+  for (; i < prices.size(); i++) {
+    if (min <= price_column[i] && price_column[i] <= max &&
+        (mask_column[i] & required) == required) {
+      result.push_back(static_cast<RowId>(i));
+    }
+  }
+  return result;
+}
+
+std::vector<RowId> HouseStore::filter_features(const std::vector<RowId> &rows,
+                                               FeatureMask required) const {
+  std::vector<RowId> result;
+  for (RowId row : rows) {
+    if ((feature_masks[row] & required) == required)
+      result.push_back(row);
+  }
+  return result;
+}
+
+HouseStore load_store(const std::string &filename, LoadMode mode) {
+  // Snapshots already have this layout, so adopt the columns as read.
+  if (is_snapshot_file(filename)) {
+    std::ifstream file(filename, std::ios::binary);
+    SnapshotColumns columns;
+    if (!read_snapshot(file, columns))
+      return {};
+    return HouseStore(std::move(columns));
+  }
+  return HouseStore(load_file(filename, mode));
+}
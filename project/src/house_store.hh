@@ -0,0 +1,87 @@
+#pragma once
+#include "features.hh"
+#include "io/snapshot.hh"
+#include "lib.hh"
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Struct-of-arrays copy of a House dataset. Every numeric field lives in its
+// own contiguous column, so a scan over prices only pulls prices through the
+// cache. Address parts and features are pooled into one string heap (the same
+// layout as the binary snapshot) and read back as string_views.
+class HouseStore {
+  std::vector<float> xs;
+  std::vector<float> ys;
+  std::vector<float> prices;
+  std::vector<float> areas;
+  std::vector<std::uint32_t> room_counts;
+  std::vector<std::uint32_t> bathroom_counts;
+  // Parsed from the features string when a row is added.
+  std::vector<FeatureMask> feature_masks;
+  std::vector<std::uint64_t> string_offsets{0};
+  std::string string_heap;
+
+  std::string_view string_at(RowId row, std::size_t field) const;
+
+public:
+  // String fields per row: house_number, cardinal, road_number, road_type,
+  // features.
+  static constexpr std::size_t strings_per_row = snapshot_strings_per_row;
+
+  HouseStore() = default;
+  explicit HouseStore(const std::vector<House> &houses);
+  // Takes over the columns of a snapshot without copying them.
+  explicit HouseStore(SnapshotColumns &&columns);
+
+  // Room for rows rows and heap_bytes bytes of strings. Adding rows within
+  // both never moves a column, so rows already added can be read meanwhile.
+  void reserve(std::size_t rows, std::size_t heap_bytes = 0);
+  // Appends a row and returns its id. Throws std::length_error once the
+  // store holds as many rows as RowId can address.
+  RowId add(const House &house);
+
+  std::size_t size() const { return prices.size(); }
+  bool empty() const { return prices.empty(); }
+
+  float price(RowId row) const { return prices[row]; }
+  float area(RowId row) const { return areas[row]; }
+  sf::Vector2f position(RowId row) const { return {xs[row], ys[row]}; }
+  unsigned int room_count(RowId row) const { return room_counts[row]; }
+  unsigned int bathroom_count(RowId row) const {
+    return bathroom_counts[row];
+  }
+  std::string_view house_number(RowId row) const { return string_at(row, 0); }
+  std::string_view cardinal(RowId row) const { return string_at(row, 1); }
+  std::string_view road_number(RowId row) const { return string_at(row, 2); }
+  std::string_view road_type(RowId row) const { return string_at(row, 3); }
+  std::string_view features(RowId row) const { return string_at(row, 4); }
+  FeatureMask feature_mask(RowId row) const { return feature_masks[row]; }
+
+  const std::vector<float> &price_column() const { return prices; }
+  const std::vector<float> &area_column() const { return areas; }
+  const std::vector<FeatureMask> &feature_mask_column() const {
+    return feature_masks;
+  }
+
+  // Rebuilds the full House for a row, e.g. for display.
+  Address address(RowId row) const;
+  House house(RowId row) const;
+
+  // Ids of every row with min <= price <= max that has all of the
+  // `required` features, in row order. Only the price and feature mask
+  // columns are read, eight rows at a time with SSE2 where available.
+  std::vector<RowId> price_range(float min, float max,
+                                 FeatureMask required = 0) const;
+
+  // The subset of rows (e.g. an index's range result) that has all of the
+  // `required` features, in the given order.
+  std::vector<RowId> filter_features(const std::vector<RowId> &rows,
+                                     FeatureMask required) const;
+};
+
+// Loads a text or snapshot file straight into a store.
+HouseStore load_store(const std::string &filename,
+                      LoadMode mode = LoadMode::Parallel);
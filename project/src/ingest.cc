@@ -0,0 +1,180 @@
+#include "ingest.hh"
+#include "io/house_parser.hh"
+#include "io/mapped_file.hh"
+#include "io/snapshot.hh"
+#include <algorithm>
+#include <fstream>
+#include <utility>
+
+// Red-black inserts made per hold of the lock.
+constexpr std::size_t rb_lock_rows = 256;
+
+Ingest::Ingest(const std::string &filename, std::size_t batch_size,
+               std::size_t row_limit)
+    : batch_size(std::max<std::size_t>(1, batch_size)),
+      row_limit(std::min(row_limit, max_rows)) {
+  worker = std::thread([this, filename] { run(filename); });
+}
+
+Ingest::~Ingest() {
+  stopping = true;
+  if (worker.joinable())
+    worker.join();
+}
+
+// Drops the rows of columns past rows.
+static void truncate_columns(SnapshotColumns &columns, std::size_t rows) {
+  for (auto *column : {&columns.x, &columns.y, &columns.price, &columns.area})
+    column->resize(rows);
+  columns.room_count.resize(rows);
+  columns.bathroom_count.resize(rows);
+  columns.string_offsets.resize(rows * snapshot_strings_per_row + 1);
+}
+
+void Ingest::run(const std::string &filename) {
+  if (is_snapshot_file(filename)) {
+    // Snapshots already have the store's layout, so the columns are adopted
+    // as read; only the indexing is batched. Nothing is indexed yet, so no
+    // search reads the store while it is replaced.
+    std::ifstream file(filename, std::ios::binary);
+    SnapshotColumns columns;
+    if (read_snapshot(file, columns)) {
+      if (columns.size() > row_limit)
+        truncate_columns(columns, row_limit);
+      store = HouseStore(std::move(columns));
+    }
+    expected_count = store.size();
+    for (std::size_t i = 0; i < store.size() && !stopping; i += batch_size)
+      index_rows(i, std::min(store.size(), i + batch_size));
+  } else {
+    MappedFile file(filename);
+    const char *cursor = file.begin();
+    const char *end = file.end();
+
+    // Reserve for every line, and for the whole file's worth of strings, so
+    // adding rows never moves the ones the UI may already be showing.
+    std::size_t lines = std::min<std::size_t>(
+        std::count(cursor, end, '\n') + 1, row_limit);
+    store.reserve(lines, static_cast<std::size_t>(end - cursor));
+    expected_count = lines;
+
+    std::vector<House> batch;
+    while (cursor != end && store.size() < row_limit && !stopping) {
+      std::size_t first = store.size();
+      batch.clear();
+      cursor = parse_some_house_lines(
+          cursor, end, batch, std::min(batch_size, row_limit - first));
+      for (const House &house : batch)
+        store.add(house);
+      index_rows(first, store.size());
+    }
+    expected_count = store.size();
+  }
+  finished = true;
+}
+
+void Ingest::index_rows(std::size_t first, std::size_t last) {
+  // B+ searches keep reading the previous versions meanwhile.
+  for (std::size_t i = first; i < last; i++) {
+    RowId row = static_cast<RowId>(i);
+    bplus3.insert(store.price(row), row);
+    bplus21.insert(store.price(row), row);
+  }
+  bplus3.publish();
+  bplus21.publish();
+
+  for (std::size_t chunk = first; chunk < last; chunk += rb_lock_rows) {
+    std::size_t chunk_end = std::min(last, chunk + rb_lock_rows);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t i = chunk; i < chunk_end; i++)
+      rbtree.insert(store.price(static_cast<RowId>(i)), static_cast<RowId>(i));
+  }
+
+  if (first < last) {
+    float low = first == 0 ? store.price(0) : min_price.load();
+    float high = first == 0 ? store.price(0) : max_price.load();
+    for (std::size_t i = first; i < last; i++) {
+      low = std::min(low, store.price(static_cast<RowId>(i)));
+      high = std::max(high, store.price(static_cast<RowId>(i)));
+    }
+    min_price = low;
+    max_price = high;
+  }
+  indexed_count = last;
+}
+
+std::pair<float, float> Ingest::price_bounds() const {
+  return {min_price, max_price};
+}
+
+std::vector<RowId> Ingest::rows(std::size_t first, std::size_t last) const {
+  last = std::min<std::size_t>(last, indexed_count);
+  if (first >= last)
+    return {};
+
+  std::vector<RowId> result;
+  result.reserve(last - first);
+  for (std::size_t i = first; i < last; i++)
+    result.push_back(static_cast<RowId>(i));
+  return result;
+}
+
+// The row ids behind a range result.
+template <typename Pointers>
+static std::vector<RowId> to_rows(const Pointers &pointers) {
+  std::vector<RowId> rows;
+  rows.reserve(pointers.size());
+  for (const RowId *row : pointers)
+    rows.push_back(*row);
+  return rows;
+}
+
+std::vector<RowId> Ingest::search(IndexKind index, float min, float max) {
+  if (index == IndexKind::BPlus3)
+    return to_rows(bplus3.snapshot().getRange(min, max));
+  if (index == IndexKind::BPlus21)
+    return to_rows(bplus21.snapshot().getRange(min, max));
+
+  std::lock_guard<std::mutex> lock(mutex);
+  return to_rows(rbtree.price_range(min, max));
+}
+
+std::size_t Ingest::search_count(IndexKind index, float min, float max) {
+  if (index == IndexKind::BPlus3)
+    return bplus3.snapshot().countRange(min, max);
+  if (index == IndexKind::BPlus21)
+    return bplus21.snapshot().countRange(min, max);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  return rbtree.count_in_range(min, max);
+}
+
+std::vector<RowId> Ingest::search_page(IndexKind index, float min, float max,
+                                       std::size_t first, std::size_t count) {
+  std::vector<RowId> rows;
+  if (index == IndexKind::RedBlack) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (std::size_t i = first; i < first + count; i++) {
+      const RowId *row = rbtree.select_in_range(min, max, i);
+      if (!row)
+        break;
+      rows.push_back(*row);
+    }
+    return rows;
+  }
+
+  auto from_tree = [&](const auto &tree) {
+    auto cursor = tree.snapshot().range(min, max, first);
+    for (std::size_t i = 0; i < count; i++) {
+      const RowId *row = cursor.next();
+      if (!row)
+        break;
+      rows.push_back(*row);
+    }
+  };
+  if (index == IndexKind::BPlus3)
+    from_tree(bplus3);
+  else
+    from_tree(bplus21);
+  return rows;
+}
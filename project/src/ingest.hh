@@ -0,0 +1,92 @@
+#pragma once
+#include "house_store.hh"
+#include "lib.hh"
+#include "structures/redblack.hh"
+#include "structures/versioned_bplustree.hh"
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// The indexes the app can search with, in the order of its mode button.
+enum class IndexKind { RedBlack, BPlus3, BPlus21 };
+
+// Loads a listings file and inserts it into every index on a worker thread,
+// one batch at a time, so the window can open straight away. Searches run
+// against whatever has been indexed so far.
+//
+// The B+ trees publish a new version after every batch, and searches on them
+// read the latest one without taking the lock, so they never wait for the
+// worker. The red-black tree is updated in place under a lock its searches
+// share, but the worker takes it for a few hundred rows at a time, so a
+// search waits for one short chunk rather than a whole batch.
+//
+// Rows go into a HouseStore with every column reserved up front, so rows
+// already indexed never move while the worker adds more. Searches hand back
+// RowIds into it and house() rebuilds a row for display. Files with more
+// rows than the red-black tree can hold are cut off at max_rows.
+class Ingest {
+  HouseStore store;
+  RedBlackTree rbtree;
+  // Every index stores row ids into store. The B+ trees have their orders
+  // fixed at compile time. Only the worker writes them.
+  VersionedBPlusTree<float, RowId, 3> bplus3;
+  VersionedBPlusTree<float, RowId, 21> bplus21;
+
+  // Guards the red-black tree.
+  std::mutex mutex;
+  std::atomic<float> min_price{0};
+  std::atomic<float> max_price{0};
+
+  std::atomic<std::size_t> indexed_count{0};
+  std::atomic<std::size_t> expected_count{0};
+  std::atomic<bool> finished{false};
+  std::atomic<bool> stopping{false};
+  std::size_t batch_size;
+  std::size_t row_limit;
+  std::thread worker;
+
+  void run(const std::string &filename);
+  void index_rows(std::size_t first, std::size_t last);
+
+public:
+  // The red-black tree's 31-bit node indexes run out before RowIds do.
+  static constexpr std::size_t max_rows = RBTree::nil;
+
+  // Rows past row_limit (at most max_rows) are left out.
+  explicit Ingest(const std::string &filename, std::size_t batch_size = 8192,
+                  std::size_t row_limit = max_rows);
+  ~Ingest();
+
+  Ingest(const Ingest &) = delete;
+  Ingest &operator=(const Ingest &) = delete;
+
+  // Rows searchable so far.
+  std::size_t indexed() const { return indexed_count; }
+  // Best guess at the final row count (the line count for text files), or 0
+  // before the file has been opened.
+  std::size_t expected() const { return expected_count; }
+  // True once every row is indexed, or the file could not be read.
+  bool done() const { return finished; }
+
+  // Lowest and highest price indexed so far.
+  std::pair<float, float> price_bounds() const;
+
+  // Rows first..last-1 in file order, stopping at indexed().
+  std::vector<RowId> rows(std::size_t first, std::size_t last) const;
+
+  // An indexed row, e.g. one a search returned.
+  House house(RowId row) const { return store.house(row); }
+
+  std::vector<RowId> search(IndexKind index, float min, float max);
+
+  // search(index, min, max).size() and matches first..first+count-1 of it,
+  // without building the full result. Every index answers both in O(log n)
+  // from subtree sizes.
+  std::size_t search_count(IndexKind index, float min, float max);
+  std::vector<RowId> search_page(IndexKind index, float min, float max,
+                                 std::size_t first, std::size_t count);
+};
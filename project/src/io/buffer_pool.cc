@@ -0,0 +1,151 @@
+#include "io/buffer_pool.hh"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+PageRef &PageRef::operator=(PageRef &&other) noexcept {
+  if (this != &other) {
+    release();
+    pool = std::exchange(other.pool, nullptr);
+    frame = other.frame;
+  }
+  return *this;
+}
+
+PageId PageRef::id() const { return pool->frames[frame].page; }
+
+const char *PageRef::data() const { return pool->frame_data(frame); }
+
+char *PageRef::edit() {
+  pool->frames[frame].dirty = true;
+  return pool->frame_data(frame);
+}
+
+void PageRef::release() {
+  if (pool)
+    --pool->frames[frame].pins;
+  pool = nullptr;
+}
+
+BufferPool::BufferPool(const std::string &filename, std::size_t frame_count,
+                       bool start_empty)
+    : frames(frame_count) {
+  if (frame_count < 2)
+    throw std::invalid_argument("BufferPool: needs at least 2 frames");
+
+  // fstream will not create a file in in|out mode, so create it first.
+  auto mode = std::ios::in | std::ios::out | std::ios::binary;
+  file.open(filename, start_empty ? mode | std::ios::trunc : mode);
+  if (!file.is_open()) {
+    std::ofstream(filename, std::ios::binary);
+    file.open(filename, mode);
+  }
+  if (!file.is_open())
+    throw std::runtime_error("BufferPool: cannot open " + filename);
+
+  file.seekg(0, std::ios::end);
+  pages = static_cast<std::size_t>(file.tellg()) / page_size;
+  bytes.reset(new char[frame_count * page_size]);
+}
+
+BufferPool::~BufferPool() {
+  try {
+    flush();
+  } catch (...) {
+    // Nothing more can be done about a failed write here.
+  }
+}
+
+std::size_t BufferPool::victim() {
+  // Two sweeps clear every reference bit, so a third means all are pinned.
+  for (std::size_t step = 0; step < 2 * frames.size() + 1; step++) {
+    std::size_t frame = hand;
+    hand = (hand + 1) % frames.size();
+    Frame &f = frames[frame];
+    if (!f.used)
+      return frame;
+    if (f.pins > 0)
+      continue;
+    if (f.referenced) {
+      f.referenced = false;
+      continue;
+    }
+    write_back(frame);
+    page_table.erase(f.page);
+    f.used = false;
+    counters.evictions++;
+    return frame;
+  }
+  throw std::runtime_error("BufferPool: every frame is pinned");
+}
+
+void BufferPool::write_back(std::size_t frame) {
+  Frame &f = frames[frame];
+  if (!f.dirty)
+    return;
+  file.seekp(static_cast<std::streamoff>(f.page) * page_size);
+  file.write(frame_data(frame), page_size);
+  if (!file)
+    throw std::runtime_error("BufferPool: page write failed");
+  f.dirty = false;
+  counters.writes++;
+}
+
+PageRef BufferPool::fetch(PageId id) {
+  if (id >= pages)
+    throw std::runtime_error("BufferPool: page past the end of the file");
+
+  auto found = page_table.find(id);
+  if (found != page_table.end()) {
+    Frame &f = frames[found->second];
+    f.pins++;
+    f.referenced = true;
+    counters.hits++;
+    return PageRef(this, found->second);
+  }
+
+  std::size_t frame = victim();
+  file.seekg(static_cast<std::streamoff>(id) * page_size);
+  file.read(frame_data(frame), page_size);
+  if (!file) {
+    // Allocated pages reach the file before they can leave the pool, so a
+    // short read means the file itself is broken.
+    file.clear();
+    throw std::runtime_error("BufferPool: page read failed");
+  }
+  counters.misses++;
+  frames[frame] = {id, 1, true, true, false};
+  page_table[id] = frame;
+  return PageRef(this, frame);
+}
+
+PageRef BufferPool::allocate() {
+  std::size_t frame = victim();
+  PageId id = static_cast<PageId>(pages++);
+  std::memset(frame_data(frame), 0, page_size);
+  // Dirty, so the page reaches the file even if it is never edited.
+  frames[frame] = {id, 1, true, true, true};
+  page_table[id] = frame;
+  return PageRef(this, frame);
+}
+
+void BufferPool::truncate(std::size_t keep) {
+  for (std::size_t frame = 0; frame < frames.size(); frame++) {
+    Frame &f = frames[frame];
+    if (f.used && f.page >= keep) {
+      if (f.pins > 0)
+        throw std::runtime_error("BufferPool: truncating a pinned page");
+      page_table.erase(f.page);
+      f = {};
+    }
+  }
+  pages = std::min(pages, keep);
+}
+
+void BufferPool::flush() {
+  for (std::size_t frame = 0; frame < frames.size(); frame++) {
+    if (frames[frame].used)
+      write_back(frame);
+  }
+  file.flush();
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Fixed-size pages of a file, cached in a fixed number of memory frames.
+//
+// A page is pinned while a PageRef to it is alive and cannot be evicted
+// until it is released. When a page that is not cached is asked for, the
+// CLOCK hand sweeps the frames: pinned frames are skipped, recently used ones
+// get a second chance, and the first other frame is written back if dirty and
+// reused. Nothing is read from the file until a page is asked for, so a
+// search only ever reads the pages on its path.
+//
+// Not thread-safe.
+
+using PageId = std::uint32_t;
+constexpr std::size_t page_size = 4096;
+
+class BufferPool;
+
+// A pinned page. Move-only; unpins when destroyed.
+class PageRef {
+  BufferPool *pool = nullptr;
+  std::size_t frame = 0;
+
+  friend class BufferPool;
+  PageRef(BufferPool *pool, std::size_t frame) : pool(pool), frame(frame) {}
+
+public:
+  PageRef() = default;
+  ~PageRef() { release(); }
+  PageRef(PageRef &&other) noexcept
+      : pool(std::exchange(other.pool, nullptr)), frame(other.frame) {}
+  PageRef &operator=(PageRef &&other) noexcept;
+  PageRef(const PageRef &) = delete;
+  PageRef &operator=(const PageRef &) = delete;
+
+  PageId id() const;
+  const char *data() const;
+  // The page's bytes for writing; marks the page dirty.
+  char *edit();
+  void release();
+};
+
+class BufferPool {
+public:
+  struct Stats {
+    std::size_t hits = 0;
+    // Pages read from the file, i.e. page faults.
+    std::size_t misses = 0;
+    std::size_t evictions = 0;
+    std::size_t writes = 0;
+    double hit_rate() const {
+      return hits + misses ? double(hits) / double(hits + misses) : 0;
+    }
+  };
+
+  // Opens filename for reading and writing, creating it if it does not
+  // exist, or emptying it when start_empty is set. Throws std::runtime_error if
+  // it cannot be opened, and std::invalid_argument for fewer than 2 frames.
+  BufferPool(const std::string &filename, std::size_t frames,
+             bool start_empty = false);
+  // Writes back every dirty page.
+  ~BufferPool();
+
+  BufferPool(const BufferPool &) = delete;
+  BufferPool &operator=(const BufferPool &) = delete;
+
+  // Pins page id, reading it from the file if it is not cached. Throws
+  // std::runtime_error if every frame is pinned or the read fails.
+  PageRef fetch(PageId id);
+  // Appends a zeroed page to the file and pins it.
+  PageRef allocate();
+  // Forgets every page past the first `keep`, e.g. before rewriting a file.
+  // The file keeps its length; allocate() overwrites those pages in turn.
+  void truncate(std::size_t keep);
+
+  // Writes back every dirty page.
+  void flush();
+
+  std::size_t page_count() const { return pages; }
+  std::size_t frame_count() const { return frames.size(); }
+  const Stats &stats() const { return counters; }
+  void reset_stats() { counters = {}; }
+
+private:
+  friend class PageRef;
+
+  struct Frame {
+    PageId page = 0;
+    std::uint32_t pins = 0;
+    bool used = false;
+    bool referenced = false;
+    bool dirty = false;
+  };
+
+  std::fstream file;
+  std::unique_ptr<char[]> bytes;
+  std::vector<Frame> frames;
+  std::unordered_map<PageId, std::size_t> page_table;
+  std::size_t hand = 0;
+  std::size_t pages = 0;
+  Stats counters;
+
+  char *frame_data(std::size_t frame) const {
+    return bytes.get() + frame * page_size;
+  }
+  // A frame to load a page into, written back and unmapped if it held one.
+  std::size_t victim();
+  void write_back(std::size_t frame);
+};
@@ -0,0 +1,147 @@
+#include "io/house_parser.hh"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <iterator>
+#include <thread>
+
+namespace {
+
+// Below this, starting threads costs more than parsing the whole buffer.
+constexpr std::size_t min_parallel_chunk = 1 << 20;
+
+bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+const char *skip_spaces(const char *first, const char *last) {
+  while (first != last && is_space(*first))
+    ++first;
+  return first;
+}
+
+// Reads the next whitespace delimited token into out and advances first past
+// it.
+bool read_token(const char *&first, const char *last, std::string &out) {
+  first = skip_spaces(first, last);
+  const char *end = first;
+  while (end != last && !is_space(*end))
+    ++end;
+  if (end == first)
+    return false;
+  out.assign(first, end);
+  first = end;
+  return true;
+}
+
+template <typename T>
+bool read_number(const char *&first, const char *last, T &out) {
+  first = skip_spaces(first, last);
+  auto [end, error] = std::from_chars(first, last, out);
+  if (error != std::errc() || (end != last && !is_space(*end)))
+    return false;
+  first = end;
+  return true;
+}
+
+} // namespace
+
+bool parse_house_line(const char *first, const char *last, House &house) {
+  if (!read_token(first, last, house.address.house_number) ||
+      !read_token(first, last, house.address.cardinal) ||
+      !read_token(first, last, house.address.road_number) ||
+      !read_token(first, last, house.address.road_type) ||
+      !read_number(first, last, house.position.x) ||
+      !read_number(first, last, house.position.y) ||
+      !read_number(first, last, house.price) ||
+      !read_number(first, last, house.area) ||
+      !read_number(first, last, house.room_count) ||
+      !read_number(first, last, house.bathroom_count)) {
+    return false;
+  }
+
+  // Features are the rest of the line, minus surrounding whitespace.
+  first = skip_spaces(first, last);
+  while (last != first && is_space(*(last - 1)))
+    --last;
+  house.features.assign(first, last);
+  return true;
+}
+
+const char *parse_some_house_lines(const char *first, const char *last,
+                                   std::vector<House> &out,
+                                   std::size_t max_rows) {
+  std::size_t added = 0;
+  while (first != last && added < max_rows) {
+    const char *line_end = static_cast<const char *>(
+        std::memchr(first, '\n', static_cast<std::size_t>(last - first)));
+    if (!line_end)
+      line_end = last;
+
+    // Parse straight into the vector's slot so the strings are never copied.
+    if (skip_spaces(first, line_end) != line_end) {
+      out.emplace_back();
+      if (parse_house_line(first, line_end, out.back()))
+        added++;
+      else
+        out.pop_back();
+    }
+
+    first = line_end == last ? last : line_end + 1;
+  }
+  return first;
+}
+
+void parse_house_lines(const char *first, const char *last,
+                       std::vector<House> &out) {
+  // Counting newlines is far cheaper than letting the vector regrow and move
+  // every House several times.
+  out.reserve(out.size() + std::count(first, last, '\n') + 1);
+  parse_some_house_lines(first, last, out, out.max_size());
+}
+
+void parse_house_lines_parallel(const char *first, const char *last,
+                                std::vector<House> &out,
+                                unsigned int threads) {
+  std::size_t size = static_cast<std::size_t>(last - first);
+  if (threads == 0) {
+    threads = static_cast<unsigned int>(std::min<std::size_t>(
+        std::max(1u, std::thread::hardware_concurrency()),
+        std::max<std::size_t>(1, size / min_parallel_chunk)));
+  }
+  if (threads <= 1 || size == 0) {
+    parse_house_lines(first, last, out);
+    return;
+  }
+
+  // Chunk i covers [bounds[i], bounds[i + 1]). Each boundary is moved forward
+  // to just past a newline so no line is split between two threads.
+  std::vector<const char *> bounds{first};
+  for (unsigned int i = 1; i < threads; i++) {
+    const char *cut = std::max(bounds.back(), first + size / threads * i);
+    const char *newline = static_cast<const char *>(
+        std::memchr(cut, '\n', static_cast<std::size_t>(last - cut)));
+    bounds.push_back(newline ? newline + 1 : last);
+  }
+  bounds.push_back(last);
+
+  std::vector<std::vector<House>> chunks(threads);
+  std::vector<std::thread> workers;
+  workers.reserve(threads);
+  for (unsigned int i = 0; i < threads; i++) {
+    workers.emplace_back([&, i] {
+      parse_house_lines(bounds[i], bounds[i + 1], chunks[i]);
+    });
+  }
+  for (std::thread &worker : workers)
+    worker.join();
+
+  // Splice in file order. Moving a House only moves its string buffers.
+  std::size_t total = out.size();
+  for (const auto &chunk : chunks)
+    total += chunk.size();
+  out.reserve(total);
+  for (auto &chunk : chunks) {
+    out.insert(out.end(), std::make_move_iterator(chunk.begin()),
+               std::make_move_iterator(chunk.end()));
+    chunk = {};
+  }
+}
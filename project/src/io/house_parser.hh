@@ -0,0 +1,29 @@
+#pragma once
+#include "lib.hh"
+#include <vector>
+
+// Parses one line (without its newline) in the format written by
+// operator<<(std::ostream&, const House&). Numbers are read with
+// std::from_chars straight out of the buffer, so no stream is involved.
+// Returns false if the line is malformed.
+bool parse_house_line(const char *first, const char *last, House &house);
+
+// Parses every non-empty line in [first, last) and appends the houses to out.
+// Malformed lines are skipped.
+void parse_house_lines(const char *first, const char *last,
+                       std::vector<House> &out);
+
+// Parses non-empty lines from first until max_rows houses have been appended
+// to out or the buffer ends, and returns where parsing stopped. Lets a caller
+// consume a buffer in batches. Does not reserve space in out.
+const char *parse_some_house_lines(const char *first, const char *last,
+                                   std::vector<House> &out,
+                                   std::size_t max_rows);
+
+// Splits [first, last) into `threads` chunks at line boundaries, parses each
+// chunk on its own thread and appends the houses to out in file order. Passing
+// 0 picks the count from the hardware and the input size, so small inputs
+// stay on the calling thread.
+void parse_house_lines_parallel(const char *first, const char *last,
+                                std::vector<House> &out,
+                                unsigned int threads = 0);
@@ -0,0 +1,91 @@
+#include "io/house_writer.hh"
+#include <algorithm>
+#include <charconv>
+#include <functional>
+#include <thread>
+
+namespace {
+
+// Rows each thread formats before its buffer is written out.
+constexpr std::size_t rows_per_chunk = 1 << 15;
+
+template <typename T> void append_number(std::string &out, T value) {
+  char buffer[32];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+// Same as the stream's std::fixed << std::setprecision(2).
+void append_fixed(std::string &out, float value) {
+  char buffer[64];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                              std::chars_format::fixed, 2);
+  out.append(buffer, result.ptr);
+}
+
+void format_range(const House *first, const House *last, std::string &out) {
+  out.clear();
+  for (; first != last; ++first)
+    format_house(*first, out);
+}
+
+} // namespace
+
+void format_house(const House &house, std::string &out) {
+  out += house.address.house_number;
+  out += ' ';
+  out += house.address.cardinal;
+  out += ' ';
+  out += house.address.road_number;
+  out += ' ';
+  out += house.address.road_type;
+  out += ' ';
+  append_fixed(out, house.position.x);
+  out += ' ';
+  append_fixed(out, house.position.y);
+  out += ' ';
+  append_fixed(out, house.price);
+  out += ' ';
+  append_fixed(out, house.area);
+  out += ' ';
+  append_number(out, house.room_count);
+  out += ' ';
+  append_number(out, house.bathroom_count);
+  out += ' ';
+  out += house.features;
+  out += '\n';
+}
+
+void write_houses(std::ostream &os, const std::vector<House> &houses,
+                  unsigned int threads) {
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<std::string> buffers(threads);
+  const House *next = houses.data();
+  const House *end = houses.data() + houses.size();
+  while (next != end) {
+    // One chunk per thread, formatted in parallel, then written in order.
+    std::vector<const House *> bounds{next};
+    for (unsigned int i = 0; i < threads && bounds.back() != end; i++) {
+      std::size_t left = static_cast<std::size_t>(end - bounds.back());
+      bounds.push_back(bounds.back() + std::min(left, rows_per_chunk));
+    }
+    std::size_t chunks = bounds.size() - 1;
+
+    std::vector<std::thread> workers;
+    for (std::size_t i = 1; i < chunks; i++) {
+      workers.emplace_back(format_range, bounds[i], bounds[i + 1],
+                           std::ref(buffers[i]));
+    }
+    format_range(bounds[0], bounds[1], buffers[0]);
+    for (std::thread &worker : workers)
+      worker.join();
+
+    for (std::size_t i = 0; i < chunks; i++) {
+      os.write(buffers[i].data(),
+               static_cast<std::streamsize>(buffers[i].size()));
+    }
+    next = bounds.back();
+  }
+}
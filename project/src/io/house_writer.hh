@@ -0,0 +1,15 @@
+#pragma once
+#include "lib.hh"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Appends the line operator<<(std::ostream&, const House&) writes for house,
+// newline included, formatting the numbers with std::to_chars.
+void format_house(const House &house, std::string &out);
+
+// Writes houses as text lines. Rows are formatted into large buffers, split
+// across `threads` threads (0 means one per hardware thread), and each buffer
+// goes to the stream in a single write, in order.
+void write_houses(std::ostream &os, const std::vector<House> &houses,
+                  unsigned int threads = 1);
@@ -0,0 +1,128 @@
+#include "io/mapped_file.hh"
+#include <utility>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(const std::string &filename) {
+  HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    return;
+
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    CloseHandle(file);
+    return;
+  }
+  file_handle = file;
+  opened = true;
+  length = static_cast<std::size_t>(file_size.QuadPart);
+
+  // Mapping an empty file fails, and there is nothing to read anyway.
+  if (length == 0)
+    return;
+
+  HANDLE mapping =
+      CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!mapping) {
+    close();
+    return;
+  }
+  mapping_handle = mapping;
+  bytes = static_cast<const char *>(
+      MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (!bytes)
+    close();
+}
+
+void MappedFile::close() {
+  if (bytes)
+    UnmapViewOfFile(bytes);
+  if (mapping_handle)
+    CloseHandle(static_cast<HANDLE>(mapping_handle));
+  if (file_handle)
+    CloseHandle(static_cast<HANDLE>(file_handle));
+  bytes = nullptr;
+  length = 0;
+  mapping_handle = nullptr;
+  file_handle = nullptr;
+  opened = false;
+}
+#else
+MappedFile::MappedFile(const std::string &filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0)
+    return;
+
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    return;
+  }
+  opened = true;
+  length = static_cast<std::size_t>(info.st_size);
+
+  // mmap rejects zero-length mappings, and there is nothing to read anyway.
+  if (length > 0) {
+    void *mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      opened = false;
+      length = 0;
+    } else {
+      bytes = static_cast<const char *>(mapped);
+      // The loaders read front to back, so let the kernel read ahead
+      // aggressively.
+      ::madvise(mapped, length, MADV_SEQUENTIAL);
+    }
+  }
+  // The mapping stays valid after the descriptor is closed.
+  ::close(fd);
+}
+
+void MappedFile::close() {
+  if (bytes)
+    ::munmap(const_cast<char *>(bytes), length);
+  bytes = nullptr;
+  length = 0;
+  opened = false;
+}
+#endif
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : bytes(std::exchange(other.bytes, nullptr)),
+      length(std::exchange(other.length, 0)),
+#ifdef _WIN32
+      file_handle(std::exchange(other.file_handle, nullptr)),
+      mapping_handle(std::exchange(other.mapping_handle, nullptr)),
+#endif
+      opened(std::exchange(other.opened, false)) {
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+  if (this != &other) {
+    close();
+    bytes = std::exchange(other.bytes, nullptr);
+    length = std::exchange(other.length, 0);
+#ifdef _WIN32
+    file_handle = std::exchange(other.file_handle, nullptr);
+    mapping_handle = std::exchange(other.mapping_handle, nullptr);
+#endif
+    opened = std::exchange(other.opened, false);
+  }
+  return *this;
+}
+
+bool MappedFile::is_open() const { return opened; }
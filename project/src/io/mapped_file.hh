@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Read-only view of a whole file. Uses mmap (or a file mapping on Windows) so
+// the loader can parse the bytes in place instead of copying them through an
+// istream.
+class MappedFile {
+  const char *bytes = nullptr;
+  std::size_t length = 0;
+#ifdef _WIN32
+  void *file_handle = nullptr;
+  void *mapping_handle = nullptr;
+#endif
+  bool opened = false;
+
+  void close();
+
+public:
+  MappedFile() = default;
+  explicit MappedFile(const std::string &filename);
+  ~MappedFile();
+
+  MappedFile(const MappedFile &) = delete;
+  MappedFile &operator=(const MappedFile &) = delete;
+  MappedFile(MappedFile &&other) noexcept;
+  MappedFile &operator=(MappedFile &&other) noexcept;
+
+  // False if the file could not be opened. An empty file is open but has no
+  // data.
+  bool is_open() const;
+
+  const char *data() const { return bytes; }
+  std::size_t size() const { return length; }
+  const char *begin() const { return bytes; }
+  const char *end() const { return bytes + length; }
+};
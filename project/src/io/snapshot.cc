@@ -0,0 +1,178 @@
+#include "io/snapshot.hh"
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+template <typename T>
+void write_column(std::ostream &os, const std::vector<T> &column) {
+  os.write(reinterpret_cast<const char *>(column.data()),
+           static_cast<std::streamsize>(column.size() * sizeof(T)));
+}
+
+template <typename T>
+bool read_column(std::istream &is, std::vector<T> &column, std::size_t size) {
+  column.resize(size);
+  is.read(reinterpret_cast<char *>(column.data()),
+          static_cast<std::streamsize>(size * sizeof(T)));
+  return static_cast<bool>(is);
+}
+
+template <typename F>
+void write_float_column(std::ostream &os, const std::vector<House> &houses,
+                        F field) {
+  std::vector<float> column;
+  column.reserve(houses.size());
+  for (const House &h : houses)
+    column.push_back(field(h));
+  write_column(os, column);
+}
+
+template <typename F>
+void write_count_column(std::ostream &os, const std::vector<House> &houses,
+                        F field) {
+  std::vector<std::uint32_t> column;
+  column.reserve(houses.size());
+  for (const House &h : houses)
+    column.push_back(field(h));
+  write_column(os, column);
+}
+
+} // namespace
+
+bool is_snapshot_file(const std::string &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  char magic[sizeof(snapshot_magic)];
+  if (!file.read(magic, sizeof(magic)))
+    return false;
+  return std::memcmp(magic, snapshot_magic, sizeof(magic)) == 0;
+}
+
+void write_snapshot(std::ostream &os, const std::vector<House> &houses) {
+  // Build the string table first, the header needs its size.
+  std::vector<std::uint64_t> offsets;
+  offsets.reserve(houses.size() * snapshot_strings_per_row + 1);
+  std::string heap;
+  offsets.push_back(0);
+  for (const House &h : houses) {
+    for (const std::string *s :
+         {&h.address.house_number, &h.address.cardinal,
+          &h.address.road_number, &h.address.road_type, &h.features}) {
+      heap += *s;
+      offsets.push_back(heap.size());
+    }
+  }
+
+  SnapshotHeader header{};
+  std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+  header.version = snapshot_version;
+  header.byte_order = snapshot_byte_order;
+  header.row_count = houses.size();
+  header.heap_size = heap.size();
+  os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+  write_float_column(os, houses, [](const House &h) { return h.position.x; });
+  write_float_column(os, houses, [](const House &h) { return h.position.y; });
+  write_float_column(os, houses, [](const House &h) { return h.price; });
+  write_float_column(os, houses, [](const House &h) { return h.area; });
+  write_count_column(os, houses, [](const House &h) { return h.room_count; });
+  write_count_column(os, houses,
+                     [](const House &h) { return h.bathroom_count; });
+  write_column(os, offsets);
+  os.write(heap.data(), static_cast<std::streamsize>(heap.size()));
+}
+
+bool write_snapshot(const std::string &filename,
+                    const std::vector<House> &houses) {
+  std::ofstream file(filename, std::ios::binary);
+  if (!file)
+    return false;
+  write_snapshot(file, houses);
+  return static_cast<bool>(file);
+}
+
+bool read_snapshot(std::istream &is, SnapshotColumns &columns) {
+  SnapshotHeader header;
+  if (!is.read(reinterpret_cast<char *>(&header), sizeof(header)))
+    return false;
+  if (std::memcmp(header.magic, snapshot_magic, sizeof(snapshot_magic)) != 0 ||
+      header.version != snapshot_version ||
+      header.byte_order != snapshot_byte_order) {
+    return false;
+  }
+
+  // The counts come from the file: check them against what the stream still
+  // holds before allocating anything from them.
+  std::istream::pos_type start = is.tellg();
+  if (start == std::istream::pos_type(-1) || !is.seekg(0, std::ios::end))
+    return false;
+  std::uint64_t remaining = static_cast<std::uint64_t>(is.tellg() - start);
+  is.seekg(start);
+  constexpr std::uint64_t row_bytes =
+      4 * sizeof(float) + 2 * sizeof(std::uint32_t) +
+      snapshot_strings_per_row * sizeof(std::uint64_t);
+  if (remaining < sizeof(std::uint64_t) ||
+      header.row_count > (remaining - sizeof(std::uint64_t)) / row_bytes ||
+      header.heap_size > remaining - sizeof(std::uint64_t) -
+                             header.row_count * row_bytes) {
+    return false;
+  }
+
+  std::size_t rows = header.row_count;
+  if (!read_column(is, columns.x, rows) || !read_column(is, columns.y, rows) ||
+      !read_column(is, columns.price, rows) ||
+      !read_column(is, columns.area, rows) ||
+      !read_column(is, columns.room_count, rows) ||
+      !read_column(is, columns.bathroom_count, rows) ||
+      !read_column(is, columns.string_offsets,
+                   rows * snapshot_strings_per_row + 1)) {
+    return false;
+  }
+
+  // Offsets index into the heap, so a corrupt table must not escape it.
+  const auto &offsets = columns.string_offsets;
+  for (std::size_t i = 1; i < offsets.size(); i++) {
+    if (offsets[i] < offsets[i - 1] || offsets[i] > header.heap_size)
+      return false;
+  }
+
+  columns.string_heap.resize(header.heap_size);
+  is.read(columns.string_heap.data(),
+          static_cast<std::streamsize>(header.heap_size));
+  return static_cast<bool>(is);
+}
+
+std::vector<House> houses_from_snapshot(const SnapshotColumns &columns) {
+  std::vector<House> houses(columns.size());
+  const auto &offsets = columns.string_offsets;
+  const char *heap = columns.string_heap.data();
+
+  auto string_at = [&](std::size_t row, std::size_t field) {
+    std::size_t index = row * snapshot_strings_per_row + field;
+    return std::string(heap + offsets[index],
+                       heap + offsets[index + 1]);
+  };
+
+  for (std::size_t i = 0; i < houses.size(); i++) {
+    House &h = houses[i];
+    h.address.house_number = string_at(i, 0);
+    h.address.cardinal = string_at(i, 1);
+    h.address.road_number = string_at(i, 2);
+    h.address.road_type = string_at(i, 3);
+    h.features = string_at(i, 4);
+    h.position = {columns.x[i], columns.y[i]};
+    h.price = columns.price[i];
+    h.area = columns.area[i];
+    h.room_count = columns.room_count[i];
+    h.bathroom_count = columns.bathroom_count[i];
+  }
+  return houses;
+}
+
+std::vector<House> load_snapshot(const std::string &filename) {
+  std::ifstream file(filename, std::ios::binary);
+  SnapshotColumns columns;
+  if (!file || !read_snapshot(file, columns))
+    return {};
+  return houses_from_snapshot(columns);
+}
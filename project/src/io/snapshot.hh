@@ -0,0 +1,63 @@
+#pragma once
+#include "lib.hh"
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Binary columnar snapshot of a House dataset.
+//
+// Layout (native byte order, checked on read):
+//   SnapshotHeader
+//   float    x[rows], y[rows], price[rows], area[rows]
+//   uint32_t room_count[rows], bathroom_count[rows]
+//   uint64_t string_offsets[rows * snapshot_strings_per_row + 1]
+//   char     string_heap[heap_size]
+//
+// Row i owns strings i * snapshot_strings_per_row ... in the order
+// house_number, cardinal, road_number, road_type, features. String j spans
+// string_heap[string_offsets[j], string_offsets[j + 1]).
+
+constexpr char snapshot_magic[4] = {'R', 'H', 'H', 'S'};
+constexpr std::uint32_t snapshot_version = 1;
+constexpr std::uint32_t snapshot_byte_order = 0x01020304;
+constexpr std::size_t snapshot_strings_per_row = 5;
+
+struct SnapshotHeader {
+  char magic[4];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint32_t reserved;
+  std::uint64_t row_count;
+  std::uint64_t heap_size;
+};
+
+struct SnapshotColumns {
+  std::vector<float> x;
+  std::vector<float> y;
+  std::vector<float> price;
+  std::vector<float> area;
+  std::vector<std::uint32_t> room_count;
+  std::vector<std::uint32_t> bathroom_count;
+  std::vector<std::uint64_t> string_offsets;
+  std::string string_heap;
+
+  std::size_t size() const { return price.size(); }
+};
+
+// True if the file starts with the snapshot magic.
+bool is_snapshot_file(const std::string &filename);
+
+void write_snapshot(std::ostream &os, const std::vector<House> &houses);
+bool write_snapshot(const std::string &filename,
+                    const std::vector<House> &houses);
+
+// Reads a whole snapshot with one bulk read per column. Returns false if the
+// stream is not a snapshot this build understands, is truncated or corrupt,
+// or cannot seek (its size bounds the header's counts).
+bool read_snapshot(std::istream &is, SnapshotColumns &columns);
+
+std::vector<House> houses_from_snapshot(const SnapshotColumns &columns);
+
+std::vector<House> load_snapshot(const std::string &filename);
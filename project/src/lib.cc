@@ -1,4 +1,7 @@
 #include "lib.hh"
+#include "io/house_parser.hh"
+#include "io/mapped_file.hh"
+#include "io/snapshot.hh"
 #include <fstream>
 #include <iomanip>
 
@@ -19,16 +22,19 @@ std::string Address::to_string() const {
 }
 
 std::ostream &operator<<(std::ostream &os, const House &house) {
-  os << house.address << " " << house.position.x << " " << house.position.y
-     << " " << std::fixed << std::setprecision(2) << house.price << " "
-     << house.area << " " << house.room_count << " " << house.bathroom_count
-     << " " << house.features << std::endl;
+  // No std::endl: flushing every row made writing large datasets crawl.
+  os << house.address << " " << std::fixed << std::setprecision(2)
+     << house.position.x << " " << house.position.y << " " << house.price
+     << " " << house.area << " " << house.room_count << " "
+     << house.bathroom_count << " " << house.features << '\n';
   return os;
 }
 
 std::istream &operator>>(std::istream &is, House &house) {
   is >> house.address >> house.position.x >> house.position.y >> house.price >>
       house.area >> house.room_count >> house.bathroom_count;
+  // Skip the separator so features don't start with a space.
+  is >> std::ws;
   std::getline(is, house.features);
   return is;
 }
@@ -41,7 +47,27 @@ std::string House::to_string() const {
          std::to_string(bathroom_count) + " " + features;
 }
 
-std::vector<House> load_file(const std::string &filename) {
+static std::vector<House> load_file_mapped(const std::string &filename,
+                                           bool parallel) {
+  std::vector<House> houses;
+  MappedFile file(filename);
+  if (file.size() == 0)
+    return houses;
+
+  if (parallel)
+    parse_house_lines_parallel(file.begin(), file.end(), houses);
+  else
+    parse_house_lines(file.begin(), file.end(), houses);
+  return houses;
+}
+
+std::vector<House> load_file(const std::string &filename, LoadMode mode) {
+  if (is_snapshot_file(filename))
+    return load_snapshot(filename);
+
+  if (mode == LoadMode::Mapped || mode == LoadMode::Parallel)
+    return load_file_mapped(filename, mode == LoadMode::Parallel);
+
   std::vector<House> houses;
   std::ifstream file(filename);
   std::string line;
@@ -1,11 +1,16 @@
 #pragma once
 #include <SFML/System/Vector2.hpp>
+#include <cstdint>
 #include <istream>
 #include <ostream>
 #include <sstream>
 #include <string>
 #include <vector>
 
+// Index of a row in a dataset: a std::vector<House> or a HouseStore. Indexes
+// can store these instead of House copies.
+using RowId = std::uint32_t;
+
 struct Address {
   std::string house_number; // 1234
   std::string cardinal;     // sw
@@ -33,4 +38,13 @@ struct House {
   std::string to_string() const;
 };
 
-std::vector<House> load_file(const std::string &filename);
+enum class LoadMode {
+  Stream,   // std::getline + std::istringstream per line.
+  Mapped,   // Memory-mapped file parsed in place with std::from_chars.
+  Parallel, // Like Mapped, with the file split across one thread per core.
+};
+
+// Binary snapshots (see io/snapshot.hh) are detected by their header and
+// loaded directly, whatever the mode.
+std::vector<House> load_file(const std::string &filename,
+                             LoadMode mode = LoadMode::Stream);
@@ -1,27 +1,25 @@
+#include "ingest.hh"
 #include "lib.hh"
-#include "structures/bplustree.hh"
 #include "structures/quadtree.hh"
-#include "structures/redblack.hh"
 #include "ui/button.hh"
 #include <SFML/Graphics.hpp>
 #include <SFML/System/Vector2.hpp>
 #include <SFML/Window/Event.hpp>
 #include <SFML/Window/WindowEnums.hpp>
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <memory>
 #include <string>
 
+// Houses shown per page.
+constexpr size_t entries_per_page = 4;
+
+// Labels for the houses on one page.
 std::vector<std::shared_ptr<UIComponent>>
-load_page(const std::vector<House *> &houses, int page_number,
-          const sf::Font &font) {
+load_page(const std::vector<House> &houses, const sf::Font &font) {
   std::vector<std::shared_ptr<UIComponent>> components;
 
-  // Calculate start and end indices for the page
-  size_t entries_per_page = 4;
-  size_t start_idx = page_number * entries_per_page;
-  size_t end_idx = std::min(start_idx + entries_per_page, houses.size());
-
   // Fixed position for the first label set
   sf::Vector2f position(700, 100);
   float y_offset_between_houses =
@@ -30,8 +28,7 @@ load_page(const std::vector<House *> &houses, int page_number,
       25.0f; // Vertical spacing between labels of the same house
 
   // Create multiple labels for each house entry in the current page
-  for (size_t i = start_idx; i < end_idx; ++i) {
-    const House &house = *houses[i];
+  for (const House &house : houses) {
     std::vector<const UIComponent *> house_labels;
 
     // Line 1: Address information
@@ -99,31 +96,25 @@ int main() {
     return -1;
   }
 
-  auto data = load_file("data_gen/data");
-
-  std::vector<House *> filtered{};
-
-  RedBlackTree rbtree{};
-  BPlusTree<float, House> bplus3{3};
-  BPlusTree<float, House> bplus21{21};
-
-  float min_price = data[0].price;
-  float max_price = data[0].price;
-
-  for (auto &dp : data) {
-    rbtree.insert(dp);
-    bplus3.insert(dp.price, dp);
-    bplus21.insert(dp.price, dp);
-    filtered.push_back(&dp);
-
-    min_price = std::min(min_price, dp.price);
-    max_price = std::max(max_price, dp.price);
-  }
+  // Loading and indexing run on a worker thread, so the window is usable
+  // straight away and searches see whatever has been indexed so far.
+  Ingest ingest("data_gen/data");
+  size_t shown_progress = 0;
+  bool ingest_done = false;
+  bool searched = false;
+  std::string search_stats;
+
+  // Everything loaded so far, listed until the first search.
+  std::vector<RowId> filtered{};
+  // The last search. Its matches are fetched a page at a time.
+  IndexKind search_kind = IndexKind::RedBlack;
+  float search_min = 0, search_max = 0;
+  size_t match_count = 0;
 
   auto loaded_stats = std::make_shared<Label>(
-      "Successfully loaded " + std::to_string(data.size()) + " entries.",
-      sf::Vector2f(5, 720 - 60 - 5), font, sf::Vector2f{0, 0}, 20,
-      sf::Color::Transparent, sf::Color(150, 150, 150));
+      "Loading entries...", sf::Vector2f(5, 720 - 60 - 5), font,
+      sf::Vector2f{0, 0}, 20, sf::Color::Transparent,
+      sf::Color(150, 150, 150));
 
   auto swap_mode = std::make_shared<Button>("Swap", sf::Vector2f(100, 250), font);
 
@@ -135,15 +126,29 @@ int main() {
   auto mode_bp21 =
       std::make_shared<Label>("B+ Tree (Order 21)", swap_mode->right(), font);
 
-  // Min price slider
+  // Min price slider. Its range follows the prices indexed so far.
   auto min_price_slider = std::make_shared<Slider>(
-      sf::Vector2f(150, 375), min_price, max_price, min_price, font,
-      sf::Vector2f(250, 10), "Min Price");
+      sf::Vector2f(150, 375), 0.0f, 1.0f, 0.0f, font, sf::Vector2f(250, 10),
+      "Min Price");
 
   // Max price slider
   auto max_price_slider = std::make_shared<Slider>(
-      sf::Vector2f(150, 450), min_price, max_price, max_price, font,
-      sf::Vector2f(250, 10), "Max Price");
+      sf::Vector2f(150, 450), 0.0f, 1.0f, 1.0f, font, sf::Vector2f(250, 10),
+      "Max Price");
+
+  // Widens a slider to newly indexed prices. A handle resting at an end of
+  // the old range follows that end.
+  auto update_slider_range = [](Slider &slider, float low, float high) {
+    if (high <= low)
+      high = low + 1;
+    bool at_min = slider.getValue() <= slider.getMin();
+    bool at_max = slider.getValue() >= slider.getMax();
+    slider.setRange(low, high);
+    if (at_min)
+      slider.setValue(low);
+    else if (at_max)
+      slider.setValue(high);
+  };
 
   // Search button
   auto search_button = std::make_shared<Button>(
@@ -176,7 +181,7 @@ int main() {
 
   // Page navigation
   int current_page = 0;
-  int total_pages = (filtered.size() + 3) / 4; // 4 houses per page
+  int total_pages = 0;
 
   auto prev_button = std::make_shared<Button>(
       "Previous", sf::Vector2f(490, 650), font, sf::Vector2f(140, 40));
@@ -184,8 +189,7 @@ int main() {
                                               font, sf::Vector2f(140, 40));
 
   auto page_indicator =
-      std::make_shared<Label>("Page " + std::to_string(current_page + 1) +
-                                  " of " + std::to_string(total_pages),
+      std::make_shared<Label>("Page 0 of " + std::to_string(total_pages),
                               sf::Vector2f(500, 600), font, sf::Vector2f{280, 60},
                               24, sf::Color::Transparent, sf::Color::Black);
 
@@ -195,9 +199,88 @@ int main() {
     next_button->setEnabled(false);
   }
 
-  auto loaded = load_page(filtered, current_page, font);
+  // The houses on a page, either from `filtered` or pulled from the index
+  // for the last search.
+  auto page_rows = [&](int page) {
+    size_t first = page * entries_per_page;
+    if (!searched) {
+      size_t last = std::min(first + entries_per_page, filtered.size());
+      first = std::min(first, last);
+      return std::vector<RowId>(filtered.begin() + first,
+                                filtered.begin() + last);
+    }
+    return ingest.search_page(search_kind, search_min, search_max, first,
+                              entries_per_page);
+  };
+
+  std::vector<std::shared_ptr<UIComponent>> loaded;
+
+  // Reloads the current page after the listing changes or the page moves,
+  // clamping the page number into range.
+  auto refresh_page = [&]() {
+    auto rows = page_rows(current_page);
+    size_t total = searched ? match_count : filtered.size();
+    total_pages = (total + entries_per_page - 1) / entries_per_page;
+    int clamped = std::max(0, std::min(current_page, total_pages - 1));
+    if (clamped != current_page) {
+      current_page = clamped;
+      rows = page_rows(current_page);
+    }
+
+    std::vector<House> houses;
+    for (RowId row : rows)
+      houses.push_back(ingest.house(row));
+    loaded = load_page(houses, font);
+
+    next_button->setEnabled(current_page < total_pages - 1);
+    prev_button->setEnabled(current_page > 0);
+
+    // Update page indicator; with no matches there is no page to be on.
+    int shown_page = total_pages == 0 ? 0 : current_page + 1;
+    page_indicator->setText("Page " + std::to_string(shown_page) + " of " +
+                            std::to_string(total_pages));
+  };
+
+  // Status line: loading progress, then the time of the last search.
+  auto update_status = [&]() {
+    std::string progress = std::to_string(shown_progress) + " of " +
+                           std::to_string(ingest.expected()) +
+                           " entries indexed";
+    if (!searched && ingest_done) {
+      loaded_stats->setText("Successfully loaded " +
+                            std::to_string(shown_progress) + " entries.");
+    } else if (!searched) {
+      loaded_stats->setText("Loading... " + progress);
+    } else if (ingest_done) {
+      loaded_stats->setText(search_stats);
+    } else {
+      loaded_stats->setText(search_stats + " (" + progress + ")");
+    }
+  };
 
   while (window.isOpen()) {
+    // Pick up progress from the ingest worker.
+    if (!ingest_done &&
+        (ingest.indexed() != shown_progress || ingest.done())) {
+      ingest_done = ingest.done();
+      shown_progress = ingest.indexed();
+
+      if (shown_progress > 0) {
+        auto [low, high] = ingest.price_bounds();
+        update_slider_range(*min_price_slider, low, high);
+        update_slider_range(*max_price_slider, low, high);
+      }
+
+      // Until the first search, list everything loaded so far.
+      if (!searched) {
+        auto fresh = ingest.rows(filtered.size(), shown_progress);
+        filtered.insert(filtered.end(), fresh.begin(), fresh.end());
+        refresh_page();
+      }
+
+      update_status();
+    }
+
     while (const std::optional event = window.pollEvent()) {
       if (event->is<sf::Event::Closed>()) {
         window.close();
@@ -212,68 +295,31 @@ int main() {
           //           << min_price_slider->getValue() << " and $"
           //           << max_price_slider->getValue() << std::endl;
 
+          // Timed: counting the matches and pulling the current page. Page
+          // flips later only pull their own rows.
           auto start = std::chrono::high_resolution_clock::now();
-          if (current_mode == 0) {
-            filtered = rbtree.price_range(min_price_slider->getValue(),
-                                          max_price_slider->getValue());
-          } else if (current_mode == 1) {
-            filtered = bplus3.getRange(min_price_slider->getValue(),
-                                       max_price_slider->getValue());
-          } else if (current_mode == 2) {
-            filtered = bplus21.getRange(min_price_slider->getValue(),
-                                        max_price_slider->getValue());
-          }
+          searched = true;
+          search_kind = static_cast<IndexKind>(current_mode);
+          search_min = min_price_slider->getValue();
+          search_max = max_price_slider->getValue();
+          match_count = ingest.search_count(search_kind, search_min, search_max);
+          refresh_page();
 
           auto end = std::chrono::high_resolution_clock::now();
           auto duration = std::chrono::duration_cast<std::chrono::microseconds>(
               end - start);
 
-          loaded_stats->setText("Search took " +
-                                std::to_string(duration.count()) +
-                                " microseconds");
-
-          total_pages = (filtered.size() + 3) / 4; // 4 houses per page
-          if (current_page >= total_pages)
-            current_page = total_pages - 1;
-          else if (current_page < 0)
-            current_page = 0;
-
-          loaded = load_page(filtered, current_page, font);
-
-          next_button->setEnabled(current_page < total_pages - 1);
-          prev_button->setEnabled(current_page > 0);
-
-          // Update page indicator
-          page_indicator->setText("Page " + std::to_string(current_page + 1) +
-                                  " of " + std::to_string(total_pages));
+          search_stats = "Search took " + std::to_string(duration.count()) +
+                         " microseconds";
+          update_status();
         } else if (prev_button->wasClicked(mouseEvent->position) &&
                    prev_button->isEnabled()) {
           current_page--;
-          loaded = load_page(filtered, current_page, font);
-
-          // Update button states
-          next_button->setEnabled(true);
-          if (current_page == 0) {
-            prev_button->setEnabled(false);
-          }
-
-          // Update page indicator
-          page_indicator->setText("Page " + std::to_string(current_page + 1) +
-                                  " of " + std::to_string(total_pages));
+          refresh_page();
         } else if (next_button->wasClicked(mouseEvent->position) &&
                    next_button->isEnabled()) {
           current_page++;
-          loaded = load_page(filtered, current_page, font);
-
-          // Update button states
-          prev_button->setEnabled(true);
-          if (current_page >= total_pages - 1) {
-            next_button->setEnabled(false);
-          }
-
-          // Update page indicator
-          page_indicator->setText("Page " + std::to_string(current_page + 1) +
-                                  " of " + std::to_string(total_pages));
+          refresh_page();
         }
       }
 
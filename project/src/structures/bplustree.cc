@@ -3,3 +3,4 @@
 
 template class BPlusTree<int, std::string>;
 template class BPlusTree<float, House>;
+template class BPlusTree<float, RowId>;
@@ -8,6 +8,7 @@
 #include <queue>
 #include <algorithm>
 #include "lib.hh"
+#include "structures/node_search.hh"
 
 template <typename K, typename V>
 class BPlusTree {
@@ -33,49 +34,189 @@ private:
     Node* root;
     size_t order;
     LeafNode* findLeaf(K key);
+    LeafNode* findFirstLeaf(const K& key);
+    void destroy(Node* node);
+    template <typename F>
+    void visitRange(const K& low, const K& high, F&& visit);
     void splitLeaf(LeafNode* leaf);
     void insertIntoParent(Node* olderChild, K key, Node* newChild);
     void splitInternal(InternalNode* node);
+    size_t childIndex(InternalNode* parent, Node* child);
+    void rebalanceLeaf(LeafNode* leaf);
+    void rebalanceInternal(InternalNode* node);
 
 
 
 public:
+    struct Stats {
+        size_t height = 0;
+        size_t leaves = 0;
+        size_t internals = 0;
+        size_t keys = 0;
+        // keys / (leaves * order): 1.0 means every leaf is full.
+        double leafFill = 0;
+        // Node objects and their vectors' storage, not counting memory owned
+        // by the values themselves (e.g. House strings).
+        size_t bytes = 0;
+    };
+
     explicit BPlusTree(size_t order);
+    // Bulk-loads `sorted`, see bulkLoad.
+    BPlusTree(size_t order, const std::vector<std::pair<K, V>>& sorted,
+              double fillFactor = 1.0);
+    ~BPlusTree();
+    BPlusTree(const BPlusTree&) = delete;
+    BPlusTree& operator=(const BPlusTree&) = delete;
+
+    // Replaces the contents with `sorted` (ascending by key), building packed
+    // leaves and then each internal level bottom-up. fillFactor is the share
+    // of each node's capacity to fill, so later inserts have room before
+    // splitting. O(n), no splits.
+    void bulkLoad(const std::vector<std::pair<K, V>>& sorted,
+                  double fillFactor = 1.0);
+    void clear();
+    Stats getStats() const;
     void insert(K key, V value);
+    // Removes one entry with this key whose value == value, borrowing from or
+    // merging with a sibling when a node drops below half full. Returns
+    // false if there was no such entry. O(log n) plus the run of equal keys.
+    // (Templates so trees of values without operator== still instantiate.)
+    template <typename U = V>
+    bool erase(const K& key, const U& value);
+    // Moves value from oldKey to newKey, e.g. a listing's price change.
+    // Returns false, changing nothing, if (oldKey, value) is not stored.
+    template <typename U = V>
+    bool update(const K& oldKey, const K& newKey, const U& value);
     void printLeaves();
     void printTree();
     V* search(K key);
     std::vector<V*> getRange(const K& low, const K& high);
+
+    // For trees whose values are row ids (e.g. BPlusTree<float, RowId>):
+    // the rows the matching ids point at in `rows`, so the leaves can stay
+    // small while callers still get the houses back.
+    template <typename Rows>
+    std::vector<typename Rows::value_type*> getRange(const K& low, const K& high, Rows& rows);
+
+    // Walks the matches of a range one at a time along the leaf chain, in
+    // the order getRange returns them. Valid until the tree is modified.
+    class RangeCursor {
+    public:
+        // The next match, or nullptr once the range is exhausted.
+        V* next();
+        // Steps over up to n matches, whole leaves at a time where it can,
+        // and returns how many it skipped.
+        size_t skip(size_t n);
+
+    private:
+        friend class BPlusTree;
+        LeafNode* leaf = nullptr;
+        size_t idx = 0;
+        K high{};
+    };
+    RangeCursor range(const K& low, const K& high);
+    // getRange(low, high).size() without building the vector.
+    size_t countRange(const K& low, const K& high);
 };
 
 template <typename K, typename V>
-std::vector<V*> BPlusTree<K,V>::getRange(const K& low, const K& high) {
-    std::vector<V*> out;
-    
+template <typename F>
+void BPlusTree<K,V>::visitRange(const K& low, const K& high, F&& visit) {
     if (!root) {
-        return out;
+        return;
     }
     //Find the first leaf that could be the low value
-    LeafNode* leaf = findLeaf(low);
+    LeafNode* leaf = findFirstLeaf(low);
     
 
     //walk to the first key >= low in that leaf
-    auto it = std::lower_bound(leaf->keys.begin(), leaf->keys.end(),low);
-    size_t idx = it - leaf->keys.begin();
+    size_t idx = node_lower_bound(leaf->keys.data(), leaf->keys.size(), low);
     
     //scan leaf pages until > high
     while (leaf) {
         for (size_t i = idx; i<leaf->keys.size(); ++i) {
             K key = leaf->keys[i];
             if (key > high) {
-                return out;
+                return;
             }
-            out.push_back(&leaf->values[i]);
+            visit(leaf->values[i]);
         }
         //next leaf
         leaf = leaf->next;
         idx=0;
     }
+}
+
+template <typename K, typename V>
+typename BPlusTree<K, V>::RangeCursor BPlusTree<K, V>::range(const K& low, const K& high) {
+    RangeCursor cursor;
+    cursor.high = high;
+    if (root) {
+        cursor.leaf = findFirstLeaf(low);
+        cursor.idx = node_lower_bound(cursor.leaf->keys.data(), cursor.leaf->keys.size(), low);
+    }
+    return cursor;
+}
+
+template <typename K, typename V>
+V* BPlusTree<K, V>::RangeCursor::next() {
+    while (leaf) {
+        if (idx < leaf->keys.size()) {
+            if (leaf->keys[idx] > high) {
+                leaf = nullptr;
+                return nullptr;
+            }
+            return &leaf->values[idx++];
+        }
+        leaf = leaf->next;
+        idx = 0;
+    }
+    return nullptr;
+}
+
+template <typename K, typename V>
+size_t BPlusTree<K, V>::RangeCursor::skip(size_t n) {
+    size_t skipped = 0;
+    while (skipped < n && leaf) {
+        size_t size = leaf->keys.size();
+        if (idx < size && !(leaf->keys.back() > high)) {
+            //the whole rest of this leaf matches
+            size_t take = std::min(size - idx, n - skipped);
+            idx += take;
+            skipped += take;
+        } else if (idx < size) {
+            //the range ends in this leaf
+            if (leaf->keys[idx] > high) {
+                leaf = nullptr;
+                break;
+            }
+            ++idx;
+            ++skipped;
+        } else {
+            leaf = leaf->next;
+            idx = 0;
+        }
+    }
+    return skipped;
+}
+
+template <typename K, typename V>
+size_t BPlusTree<K, V>::countRange(const K& low, const K& high) {
+    return range(low, high).skip(std::numeric_limits<size_t>::max());
+}
+
+template <typename K, typename V>
+std::vector<V*> BPlusTree<K,V>::getRange(const K& low, const K& high) {
+    std::vector<V*> out;
+    visitRange(low, high, [&](V& value) { out.push_back(&value); });
+    return out;
+}
+
+template <typename K, typename V>
+template <typename Rows>
+std::vector<typename Rows::value_type*> BPlusTree<K,V>::getRange(const K& low, const K& high, Rows& rows) {
+    std::vector<typename Rows::value_type*> out;
+    visitRange(low, high, [&](V& id) { out.push_back(&rows[id]); });
     return out;
 }
 template<typename K, typename V>
@@ -141,28 +282,20 @@ void BPlusTree<K, V>::printLeaves() {
 
 template <typename K, typename V>
 V* BPlusTree<K, V>::search(K key) {
-    // 1) Find the first leaf that *could* contain the key
-    LeafNode* leaf = findLeaf(key);
-
-    // 2) Walk forward through the linked list of leaves
-    while (leaf) {
-        // 3) Scan this leaf’s keys linearly
-        for (size_t i = 0; i < leaf->keys.size(); ++i) {
-            if (leaf->keys[i] == key) {
-                // found it!
-                return &leaf->values[i];
-            }
-        }
-
-        // 4) If this leaf’s largest key is already > our search key, we can stop
-        if (!leaf->keys.empty() && leaf->keys.back() > key) {
-            break;
-        }
-
-        // 5) Otherwise advance to the next leaf in the linked list
+    if (!root) {
+        return nullptr;
+    }
+    // The leftmost leaf that could hold the key; if every key there is
+    // smaller, the first candidate is at the start of the next leaf.
+    LeafNode* leaf = findFirstLeaf(key);
+    size_t idx = node_lower_bound(leaf->keys.data(), leaf->keys.size(), key);
+    if (idx == leaf->keys.size()) {
         leaf = leaf->next;
+        idx = 0;
+    }
+    if (leaf && idx < leaf->keys.size() && leaf->keys[idx] == key) {
+        return &leaf->values[idx];
     }
-
     // not found
     return nullptr;
 }
@@ -313,15 +446,27 @@ typename BPlusTree<K, V>::LeafNode* BPlusTree<K, V>::findLeaf(K key) {
     */
     while (!current->isLeaf) {
         InternalNode* internal = static_cast<InternalNode*>(current);
-        size_t i = 0;
-        while (i < internal->keys.size() && key >= internal->keys[i]) {
-            ++i;
-        }
+        size_t i = node_upper_bound(internal->keys.data(),
+                                    internal->keys.size(), key);
         current = internal->children[i];
     }
 
     return static_cast<LeafNode*>(current);
 }
+//Find the leftmost leaf that could hold key. Separators are the first key of
+//the right child, so with duplicate keys equal entries can also sit at the end
+//of the left child; a range scan has to start there.
+template <typename K, typename V>
+typename BPlusTree<K, V>::LeafNode* BPlusTree<K, V>::findFirstLeaf(const K& key) {
+    Node* current = root;
+    while (!current->isLeaf) {
+        InternalNode* internal = static_cast<InternalNode*>(current);
+        size_t i = node_lower_bound(internal->keys.data(),
+                                    internal->keys.size(), key);
+        current = internal->children[i];
+    }
+    return static_cast<LeafNode*>(current);
+}
 //Insert
 template <typename K, typename V>
 void BPlusTree<K, V>::insert(K key, V value) {
@@ -340,8 +485,7 @@ void BPlusTree<K, V>::insert(K key, V value) {
     LeafNode* leaf = findLeaf(key);
 
     //finds where to insert the key
-    auto it = std::lower_bound(leaf->keys.begin(), leaf->keys.end(), key);
-    int index = it - leaf->keys.begin();
+    size_t index = node_lower_bound(leaf->keys.data(), leaf->keys.size(), key);
 
     leaf->keys.insert(leaf->keys.begin() + index, key);
     leaf->values.insert(leaf->values.begin() + index, value);
@@ -349,12 +493,321 @@ void BPlusTree<K, V>::insert(K key, V value) {
         splitLeaf(leaf);
     }
 }
+//Erase
+template <typename K, typename V>
+template <typename U>
+bool BPlusTree<K, V>::erase(const K& key, const U& value) {
+    if (!root) {
+        return false;
+    }
+    //Equal keys can run across several leaves, so walk them from the first.
+    LeafNode* leaf = findFirstLeaf(key);
+    size_t idx = node_lower_bound(leaf->keys.data(), leaf->keys.size(), key);
+    while (leaf) {
+        while (idx < leaf->keys.size() && leaf->keys[idx] == key &&
+               !(leaf->values[idx] == value)) {
+            ++idx;
+        }
+        if (idx < leaf->keys.size()) {
+            break;
+        }
+        leaf = leaf->next;
+        idx = 0;
+    }
+    if (!leaf || !(leaf->keys[idx] == key)) {
+        return false;
+    }
+
+    leaf->keys.erase(leaf->keys.begin() + idx);
+    leaf->values.erase(leaf->values.begin() + idx);
+    rebalanceLeaf(leaf);
+    return true;
+}
+
+template <typename K, typename V>
+template <typename U>
+bool BPlusTree<K, V>::update(const K& oldKey, const K& newKey, const U& value) {
+    V moved = value;
+    if (!erase(oldKey, moved)) {
+        return false;
+    }
+    insert(newKey, moved);
+    return true;
+}
+
+template <typename K, typename V>
+size_t BPlusTree<K, V>::childIndex(InternalNode* parent, Node* child) {
+    return std::find(parent->children.begin(), parent->children.end(), child) -
+           parent->children.begin();
+}
+
+//Leaves may drop to order/2 keys; below that they borrow a key from a
+//sibling that can spare one, or merge with it. Separators stay valid lower
+//bounds of their right subtree throughout, so only borrows rewrite them.
+template <typename K, typename V>
+void BPlusTree<K, V>::rebalanceLeaf(LeafNode* leaf) {
+    size_t minKeys = std::max<size_t>(1, order / 2);
+    if (leaf == root) {
+        if (leaf->keys.empty()) {
+            delete leaf;
+            root = nullptr;
+        }
+        return;
+    }
+    if (leaf->keys.size() >= minKeys) {
+        return;
+    }
+
+    InternalNode* parent = static_cast<InternalNode*>(leaf->parent);
+    size_t i = childIndex(parent, leaf);
+    LeafNode* left = i > 0 ? static_cast<LeafNode*>(parent->children[i - 1]) : nullptr;
+    LeafNode* right = i + 1 < parent->children.size()
+                          ? static_cast<LeafNode*>(parent->children[i + 1])
+                          : nullptr;
+
+    if (left && left->keys.size() > minKeys) {
+        leaf->keys.insert(leaf->keys.begin(), left->keys.back());
+        leaf->values.insert(leaf->values.begin(), left->values.back());
+        left->keys.pop_back();
+        left->values.pop_back();
+        parent->keys[i - 1] = leaf->keys.front();
+        return;
+    }
+    if (right && right->keys.size() > minKeys) {
+        leaf->keys.push_back(right->keys.front());
+        leaf->values.push_back(right->values.front());
+        right->keys.erase(right->keys.begin());
+        right->values.erase(right->values.begin());
+        parent->keys[i] = right->keys.front();
+        return;
+    }
+
+    //Merge the right one of the pair into the left one.
+    if (!right) {
+        right = leaf;
+        leaf = left;
+        --i;
+    }
+    leaf->keys.insert(leaf->keys.end(), right->keys.begin(), right->keys.end());
+    leaf->values.insert(leaf->values.end(), right->values.begin(), right->values.end());
+    leaf->next = right->next;
+    parent->keys.erase(parent->keys.begin() + i);
+    parent->children.erase(parent->children.begin() + i + 1);
+    delete right;
+    rebalanceInternal(parent);
+}
+
+//Internal nodes keep at least half of their `order` children, the same way.
+template <typename K, typename V>
+void BPlusTree<K, V>::rebalanceInternal(InternalNode* node) {
+    size_t minChildren = std::max<size_t>(2, (order + 1) / 2);
+    if (node == root) {
+        if (node->children.size() == 1) {
+            root = node->children.front();
+            root->parent = nullptr;
+            node->children.clear();
+            delete node;
+        }
+        return;
+    }
+    if (node->children.size() >= minChildren) {
+        return;
+    }
+
+    InternalNode* parent = static_cast<InternalNode*>(node->parent);
+    size_t i = childIndex(parent, node);
+    InternalNode* left = i > 0 ? static_cast<InternalNode*>(parent->children[i - 1]) : nullptr;
+    InternalNode* right = i + 1 < parent->children.size()
+                              ? static_cast<InternalNode*>(parent->children[i + 1])
+                              : nullptr;
+
+    //Borrowing rotates a child through the parent's separator.
+    if (left && left->children.size() > minChildren) {
+        node->keys.insert(node->keys.begin(), parent->keys[i - 1]);
+        node->children.insert(node->children.begin(), left->children.back());
+        node->children.front()->parent = node;
+        parent->keys[i - 1] = left->keys.back();
+        left->keys.pop_back();
+        left->children.pop_back();
+        return;
+    }
+    if (right && right->children.size() > minChildren) {
+        node->keys.push_back(parent->keys[i]);
+        node->children.push_back(right->children.front());
+        node->children.back()->parent = node;
+        parent->keys[i] = right->keys.front();
+        right->keys.erase(right->keys.begin());
+        right->children.erase(right->children.begin());
+        return;
+    }
+
+    //Merge, pulling the separator down between the two halves.
+    if (!right) {
+        right = node;
+        node = left;
+        --i;
+    }
+    node->keys.push_back(parent->keys[i]);
+    node->keys.insert(node->keys.end(), right->keys.begin(), right->keys.end());
+    for (Node* child : right->children) {
+        child->parent = node;
+        node->children.push_back(child);
+    }
+    right->children.clear();
+    parent->keys.erase(parent->keys.begin() + i);
+    parent->children.erase(parent->children.begin() + i + 1);
+    delete right;
+    rebalanceInternal(parent);
+}
 template <typename K, typename V>
 BPlusTree<K, V>::BPlusTree(size_t order) : root(nullptr), order(order) {}
 
+template <typename K, typename V>
+BPlusTree<K, V>::BPlusTree(size_t order,
+                           const std::vector<std::pair<K, V>>& sorted,
+                           double fillFactor)
+    : root(nullptr), order(order) {
+    bulkLoad(sorted, fillFactor);
+}
+
+template <typename K, typename V>
+BPlusTree<K, V>::~BPlusTree() {
+    clear();
+}
+
+template <typename K, typename V>
+void BPlusTree<K, V>::destroy(Node* node) {
+    if (!node->isLeaf) {
+        for (Node* child : static_cast<InternalNode*>(node)->children)
+            destroy(child);
+    }
+    delete node;
+}
+
+template <typename K, typename V>
+void BPlusTree<K, V>::clear() {
+    if (root)
+        destroy(root);
+    root = nullptr;
+}
+
+//Bulk load
+template <typename K, typename V>
+void BPlusTree<K, V>::bulkLoad(const std::vector<std::pair<K, V>>& sorted,
+                               double fillFactor) {
+    clear();
+    if (sorted.empty()) {
+        return;
+    }
+
+    //How many entries (leaves) or children (internal nodes) to aim for per
+    //node. Leaves hold up to `order` keys, internal nodes `order` children.
+    auto target = [&](size_t minimum) {
+        double wanted = static_cast<double>(order) * fillFactor;
+        return std::max(minimum, std::min(order, static_cast<size_t>(wanted)));
+    };
+
+    //Spreads `count` items over the fewest nodes of size <= per, evenly, so
+    //the last node is not left nearly empty. Returns each node's size.
+    auto spread = [](size_t count, size_t per) {
+        size_t nodes = (count + per - 1) / per;
+        std::vector<size_t> sizes(nodes, count / nodes);
+        for (size_t i = 0; i < count % nodes; ++i)
+            ++sizes[i];
+        return sizes;
+    };
+
+    //Leaf level. levelMin[i] is the smallest key under level[i], which is the
+    //separator its parent needs.
+    std::vector<Node*> level;
+    std::vector<K> levelMin;
+    LeafNode* previous = nullptr;
+    size_t pos = 0;
+    for (size_t size : spread(sorted.size(), target(1))) {
+        LeafNode* leaf = new LeafNode();
+        leaf->keys.reserve(size);
+        leaf->values.reserve(size);
+        for (size_t i = 0; i < size; ++i, ++pos) {
+            leaf->keys.push_back(sorted[pos].first);
+            leaf->values.push_back(sorted[pos].second);
+        }
+        if (previous)
+            previous->next = leaf;
+        previous = leaf;
+        level.push_back(leaf);
+        levelMin.push_back(leaf->keys.front());
+    }
+
+    //Internal levels, until one node is left.
+    while (level.size() > 1) {
+        size_t per = target(2);
+        //With a small fanout, spreading can leave a node with one child; take
+        //one node fewer if the rest still fit.
+        size_t parents = (level.size() + per - 1) / per;
+        if (parents > 1 && level.size() < 2 * parents &&
+            (level.size() + parents - 2) / (parents - 1) <= order) {
+            per = (level.size() + parents - 2) / (parents - 1);
+        }
+
+        std::vector<Node*> next;
+        std::vector<K> nextMin;
+        size_t child = 0;
+        for (size_t size : spread(level.size(), per)) {
+            InternalNode* node = new InternalNode();
+            node->children.reserve(size);
+            node->keys.reserve(size - 1);
+            for (size_t i = 0; i < size; ++i, ++child) {
+                if (i > 0)
+                    node->keys.push_back(levelMin[child]);
+                node->children.push_back(level[child]);
+                level[child]->parent = node;
+            }
+            nextMin.push_back(levelMin[child - size]);
+            next.push_back(node);
+        }
+        level = std::move(next);
+        levelMin = std::move(nextMin);
+    }
+    root = level.front();
+}
+
+template <typename K, typename V>
+typename BPlusTree<K, V>::Stats BPlusTree<K, V>::getStats() const {
+    Stats stats;
+    if (!root) {
+        return stats;
+    }
+
+    std::vector<const Node*> levelNodes{root};
+    while (!levelNodes.empty()) {
+        ++stats.height;
+        std::vector<const Node*> below;
+        for (const Node* node : levelNodes) {
+            stats.bytes += node->keys.capacity() * sizeof(K);
+            if (node->isLeaf) {
+                auto leaf = static_cast<const LeafNode*>(node);
+                ++stats.leaves;
+                stats.keys += node->keys.size();
+                stats.bytes += sizeof(LeafNode) + leaf->values.capacity() * sizeof(V);
+            } else {
+                ++stats.internals;
+                auto in = static_cast<const InternalNode*>(node);
+                stats.bytes += sizeof(InternalNode) + in->children.capacity() * sizeof(Node*);
+                below.insert(below.end(), in->children.begin(),
+                             in->children.end());
+            }
+        }
+        levelNodes = std::move(below);
+    }
+    stats.leafFill = static_cast<double>(stats.keys) /
+                     (static_cast<double>(stats.leaves) * order);
+    return stats;
+}
+
 
 extern template class BPlusTree<int, std::string>;
 extern template class BPlusTree<float, House>;
+extern template class BPlusTree<float, RowId>;
 
 
 
@@ -0,0 +1,4 @@
+#include "structures/bucket_quadtree.hh"
+
+template class BucketQuadtree<sf::Vector2f>;
+template class BucketQuadtree<House>;
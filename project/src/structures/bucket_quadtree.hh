@@ -0,0 +1,190 @@
+#pragma once
+
+#include "lib.hh"
+#include "structures/quadtree.hh"
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// A Quadtree whose leaves hold up to bucket_size items by value, in one
+// contiguous array, and split into all four quadrants at once when a new
+// item arrives at a full leaf. Internal nodes hold no items.
+//
+// Compared with Quadtree, which keeps one item per node behind its own
+// unique_ptr, there are about bucket_size times fewer nodes, searches test
+// whole arrays of items per node visited, and a node the search circle
+// covers entirely is taken without testing its items. Leaves at max_depth
+// never split, so many items at one position cannot deepen the tree forever.
+//
+// Items move when a leaf splits, so pointers returned by a search are only
+// valid until the next add_item.
+template <class T> class BucketQuadtree {
+  struct Node {
+    float left = 0.0f;
+    float right = 1.0f;
+    float top = 0.0f;
+    float bottom = 1.0f;
+    // Top left, top right, bottom left, bottom right; null for a leaf.
+    std::unique_ptr<Node[]> children;
+    std::vector<T> items;
+
+    size_t quadrant(sf::Vector2f pos) const {
+      return (pos.y >= (top + bottom) / 2.0f ? 2 : 0) +
+             (pos.x >= (left + right) / 2.0f ? 1 : 0);
+    }
+
+    // Gives the four children their bounds.
+    void make_children() {
+      float mid_x = (left + right) / 2.0f;
+      float mid_y = (top + bottom) / 2.0f;
+      children = std::make_unique<Node[]>(4);
+      for (size_t i = 0; i < 4; i++) {
+        Node &child = children[i];
+        child.left = i & 1 ? mid_x : left;
+        child.right = i & 1 ? right : mid_x;
+        child.top = i & 2 ? mid_y : top;
+        child.bottom = i & 2 ? bottom : mid_y;
+      }
+    }
+  };
+
+  Node root;
+  size_t bucket_size;
+
+  static bool is_in_bounds(const Node &node, sf::Vector2f item) {
+    return item.x >= node.left && item.x < node.right && item.y >= node.top &&
+           item.y < node.bottom;
+  }
+
+  // Doubles the root towards target, as Quadtree::expand_towards does. The
+  // old root becomes the quadrant away from the target.
+  void expand_towards(sf::Vector2f target) {
+    bool is_left = target.x < root.left;
+    bool is_up = target.y < root.top;
+
+    Node old = std::exchange(root, Node{});
+    root.left = is_left ? old.left - (old.right - old.left) : old.left;
+    root.right = is_left ? old.right : old.right + (old.right - old.left);
+    root.top = is_up ? old.top - (old.bottom - old.top) : old.top;
+    root.bottom = is_up ? old.bottom : old.bottom + (old.bottom - old.top);
+    root.make_children();
+    root.children[(is_up ? 2 : 0) + (is_left ? 1 : 0)] = std::move(old);
+  }
+
+  static void add_all(const Node &node, std::vector<T *> &result) {
+    for (const T &item : node.items)
+      result.push_back(const_cast<T *>(&item));
+    if (node.children) {
+      for (size_t i = 0; i < 4; i++)
+        add_all(node.children[i], result);
+    }
+  }
+
+  static void find_in_radius_helper(const Node &node, sf::Vector2f center,
+                                    float radius, std::vector<T *> &result) {
+    // Nearest point of the node to the center: nothing inside if it is out
+    // of range.
+    float dx = std::max(0.0f, std::max(center.x - node.right,
+                                       node.left - center.x));
+    float dy = std::max(0.0f, std::max(center.y - node.bottom,
+                                       node.top - center.y));
+    if (dx * dx + dy * dy > radius * radius)
+      return;
+
+    // Farthest corner: everything inside if it is in range.
+    float fx = std::max(center.x - node.left, node.right - center.x);
+    float fy = std::max(center.y - node.top, node.bottom - center.y);
+    if (fx * fx + fy * fy <= radius * radius) {
+      add_all(node, result);
+      return;
+    }
+
+    for (const T &item : node.items) {
+      if ((get_position(item) - center).lengthSquared() <= radius * radius)
+        result.push_back(const_cast<T *>(&item));
+    }
+    if (node.children) {
+      for (size_t i = 0; i < 4; i++)
+        find_in_radius_helper(node.children[i], center, radius, result);
+    }
+  }
+
+  static void stats_helper(const Node &node, QuadtreeStats &stats,
+                           size_t depth) {
+    stats.nodes++;
+    stats.max_depth = std::max(stats.max_depth, depth);
+    stats.items += node.items.size();
+    stats.bytes += sizeof(Node) + node.items.capacity() * sizeof(T);
+    if (node.children) {
+      for (size_t i = 0; i < 4; i++)
+        stats_helper(node.children[i], stats, depth + 1);
+    }
+  }
+
+public:
+  // Deep enough to separate any two distinct float positions in a sensibly
+  // sized world.
+  static constexpr size_t max_depth = 32;
+
+  explicit BucketQuadtree(size_t bucket_size = 16) : bucket_size(bucket_size) {
+    if (bucket_size == 0)
+      throw std::invalid_argument("BucketQuadtree: bucket_size must be > 0");
+  }
+
+  BucketQuadtree(float left_bound, float right_bound, float top_bound,
+                 float bottom_bound, size_t bucket_size = 16)
+      : BucketQuadtree(bucket_size) {
+    root.left = left_bound;
+    root.right = right_bound;
+    root.top = top_bound;
+    root.bottom = bottom_bound;
+  }
+
+  void add_item(T &&item) {
+    const sf::Vector2f pos = get_position(item);
+    while (!is_in_bounds(root, pos))
+      expand_towards(pos);
+
+    Node *node = &root;
+    size_t depth = 0;
+    while (true) {
+      if (node->children) {
+        node = &node->children[node->quadrant(pos)];
+        depth++;
+      } else if (node->items.size() < bucket_size || depth >= max_depth) {
+        node->items.push_back(std::move(item));
+        return;
+      } else {
+        // Split the full leaf; a child can receive the whole bucket, in
+        // which case the next pass splits it again.
+        node->make_children();
+        for (T &held : node->items)
+          node->children[node->quadrant(get_position(held))].items.push_back(
+              std::move(held));
+        node->items = {};
+      }
+    }
+  }
+
+  void add_item(std::unique_ptr<T> &&item) { add_item(std::move(*item)); }
+
+  std::vector<T *> find_in_radius(sf::Vector2f center, float radius) {
+    std::vector<T *> result;
+    find_in_radius_helper(root, center, radius, result);
+    return result;
+  }
+
+  size_t get_bucket_size() const { return bucket_size; }
+
+  QuadtreeStats stats() const {
+    QuadtreeStats stats;
+    stats_helper(root, stats, 0);
+    return stats;
+  }
+};
+
+extern template class BucketQuadtree<sf::Vector2f>;
+extern template class BucketQuadtree<House>;
@@ -0,0 +1,7 @@
+#include "flat_bplustree.hh"
+
+template class FlatBPlusTree<float, RowId>;
+template class FlatBPlusTree<float, RowId, 3>;
+template class FlatBPlusTree<float, RowId, 21>;
+template class FlatBPlusTree<int, int>;
+template class FlatBPlusTree<int, int, 4>;
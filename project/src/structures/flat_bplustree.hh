@@ -0,0 +1,551 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "lib.hh"
+#include "structures/node_search.hh"
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#define FLAT_BPLUS_PREFETCH(p) \
+    _mm_prefetch(reinterpret_cast<const char*>(p), _MM_HINT_T0)
+#else
+#define FLAT_BPLUS_PREFETCH(p) __builtin_prefetch(p)
+#endif
+
+// A B+ tree that behaves like BPlusTree (leaves hold up to `order` keys,
+// duplicate keys are allowed, getRange returns every match in key order) but
+// lays its nodes out flat. Each node is one block of whole cache lines with
+// its header, keys and children or values inline, and every block lives in a
+// single arena addressed by 32-bit node ids. Visiting a node touches one
+// contiguous block instead of a node object plus separate key, child and
+// value vectors, and clear() frees the whole tree at once.
+//
+// Keys and values are moved around as raw bytes, so both must be trivially
+// copyable (e.g. float keys and RowId values). order must be at least 3.
+//
+// With Order = 0 the order is picked at run time. A nonzero Order fixes it
+// at compile time: block offsets become constants and nodes of up to
+// node_search_linear_max keys are searched with a fixed-length loop over the
+// whole key array, which the compiler unrolls and vectorizes.
+template <typename K, typename V, size_t Order = 0>
+class FlatBPlusTree {
+    static_assert(std::is_trivially_copyable_v<K> &&
+                      std::is_trivially_copyable_v<V>,
+                  "FlatBPlusTree stores keys and values as raw bytes");
+
+public:
+    using NodeId = std::uint32_t;
+    static constexpr NodeId none = std::numeric_limits<NodeId>::max();
+    static constexpr size_t lineSize = 64;
+
+    struct Stats {
+        size_t height = 0;
+        size_t leaves = 0;
+        size_t internals = 0;
+        size_t keys = 0;
+        // keys / (leaves * order): 1.0 means every leaf is full.
+        double leafFill = 0;
+        // The arena, i.e. every node block including unused slots.
+        size_t bytes = 0;
+    };
+
+    // Throws std::invalid_argument if order is below 3, or differs from a
+    // nonzero Order.
+    explicit FlatBPlusTree(size_t order = Order);
+    // Bulk-loads `sorted`, see bulkLoad.
+    FlatBPlusTree(size_t order, const std::vector<std::pair<K, V>>& sorted,
+                  double fillFactor = 1.0);
+
+    // Same as BPlusTree::bulkLoad: packed leaves, then each internal level
+    // bottom-up, filling each node to fillFactor of its capacity.
+    void bulkLoad(const std::vector<std::pair<K, V>>& sorted,
+                  double fillFactor = 1.0);
+    void clear();
+    Stats getStats() const;
+    // Bytes per node block, a multiple of lineSize.
+    size_t nodeBytes() const { return layout().stride; }
+    size_t getOrder() const { return layout().order; }
+    void insert(K key, V value);
+    V* search(K key);
+    std::vector<V*> getRange(const K& low, const K& high);
+
+    // For trees whose values are row ids: the rows they point at in `rows`.
+    template <typename Rows>
+    std::vector<typename Rows::value_type*> getRange(const K& low, const K& high, Rows& rows);
+
+    // Walks the matches of a range one at a time along the leaf chain, in
+    // the order getRange returns them. Valid until the tree is modified.
+    class RangeCursor {
+    public:
+        // The next match, or nullptr once the range is exhausted.
+        V* next();
+        // Steps over up to n matches, whole leaves at a time where it can,
+        // and returns how many it skipped.
+        size_t skip(size_t n);
+
+    private:
+        friend class FlatBPlusTree;
+        FlatBPlusTree* tree = nullptr;
+        NodeId leaf = none;
+        size_t idx = 0;
+        K high{};
+    };
+    RangeCursor range(const K& low, const K& high);
+    // getRange(low, high).size() without building the vector.
+    size_t countRange(const K& low, const K& high);
+
+private:
+    struct alignas(lineSize) Line {
+        unsigned char bytes[lineSize];
+    };
+    struct Header {
+        NodeId next;  // next leaf, or none
+        std::uint32_t count;  // keys in use
+        bool isLeaf;
+    };
+    // Deep enough for 2^32 nodes at the smallest fanout.
+    static constexpr size_t maxHeight = 40;
+
+    // Byte offsets within a block. Blocks have room for one key and one
+    // child or value more than a node keeps, so an insert can overflow the
+    // node before it is split, as in BPlusTree.
+    struct Layout {
+        size_t order;
+        size_t keysOffset;
+        size_t slotsOffset;
+        size_t stride;
+    };
+    static constexpr Layout layoutFor(size_t order) {
+        auto roundUp = [](size_t n, size_t to) { return (n + to - 1) / to * to; };
+        size_t slotAlign = std::max(alignof(V), alignof(NodeId));
+        size_t slotSize = std::max(sizeof(V), sizeof(NodeId));
+        size_t keysOffset = roundUp(sizeof(Header), alignof(K));
+        size_t slotsOffset = roundUp(keysOffset + (order + 1) * sizeof(K), slotAlign);
+        return {order, keysOffset, slotsOffset,
+                roundUp(slotsOffset + (order + 1) * slotSize, lineSize)};
+    }
+    static constexpr Layout fixedLayout = layoutFor(Order);
+    Layout runtimeLayout;
+    const Layout& layout() const {
+        if constexpr (Order != 0)
+            return fixedLayout;
+        else
+            return runtimeLayout;
+    }
+    size_t lowerBound(const K* ks, size_t n, const K& key) const;
+    size_t upperBound(const K* ks, size_t n, const K& key) const;
+
+    std::vector<Line> arena;
+    NodeId nodeCount = 0;
+    NodeId root = none;
+
+    unsigned char* block(NodeId id) {
+        return arena[id * (layout().stride / lineSize)].bytes;
+    }
+    const unsigned char* block(NodeId id) const {
+        return arena[id * (layout().stride / lineSize)].bytes;
+    }
+    Header& header(NodeId id) { return *reinterpret_cast<Header*>(block(id)); }
+    const Header& header(NodeId id) const {
+        return *reinterpret_cast<const Header*>(block(id));
+    }
+    K* keys(NodeId id) { return reinterpret_cast<K*>(block(id) + layout().keysOffset); }
+    V* values(NodeId id) { return reinterpret_cast<V*>(block(id) + layout().slotsOffset); }
+    NodeId* children(NodeId id) {
+        return reinterpret_cast<NodeId*>(block(id) + layout().slotsOffset);
+    }
+    const NodeId* children(NodeId id) const {
+        return reinterpret_cast<const NodeId*>(block(id) + layout().slotsOffset);
+    }
+
+    NodeId allocate(bool isLeaf);
+    NodeId findFirstLeaf(const K& key);
+    template <typename F>
+    void visitRange(const K& low, const K& high, F&& visit);
+};
+
+template <typename K, typename V, size_t Order>
+FlatBPlusTree<K, V, Order>::FlatBPlusTree(size_t order)
+    : runtimeLayout(layoutFor(order)) {
+    if (order < 3 || (Order != 0 && order != Order)) {
+        throw std::invalid_argument("FlatBPlusTree: bad order");
+    }
+}
+
+template <typename K, typename V, size_t Order>
+size_t FlatBPlusTree<K, V, Order>::lowerBound(const K* ks, size_t n, const K& key) const {
+    if constexpr (Order != 0 && Order + 1 <= node_search_linear_max &&
+                  std::is_arithmetic_v<K>)
+        return node_lower_bound_fixed<Order + 1>(ks, n, key);
+    else
+        return node_lower_bound(ks, n, key);
+}
+
+template <typename K, typename V, size_t Order>
+size_t FlatBPlusTree<K, V, Order>::upperBound(const K* ks, size_t n, const K& key) const {
+    if constexpr (Order != 0 && Order + 1 <= node_search_linear_max &&
+                  std::is_arithmetic_v<K>)
+        return node_upper_bound_fixed<Order + 1>(ks, n, key);
+    else
+        return node_upper_bound(ks, n, key);
+}
+
+template <typename K, typename V, size_t Order>
+FlatBPlusTree<K, V, Order>::FlatBPlusTree(size_t order,
+                                          const std::vector<std::pair<K, V>>& sorted,
+                                          double fillFactor)
+    : FlatBPlusTree(order) {
+    bulkLoad(sorted, fillFactor);
+}
+
+template <typename K, typename V, size_t Order>
+typename FlatBPlusTree<K, V, Order>::NodeId FlatBPlusTree<K, V, Order>::allocate(bool isLeaf) {
+    if (nodeCount == none) {
+        throw std::length_error("FlatBPlusTree: too many nodes for a 32-bit id");
+    }
+    //May move the arena; callers re-fetch pointers into it afterwards. New
+    //blocks are zeroed, so fixed-length key scans never read garbage.
+    arena.resize(arena.size() + layout().stride / lineSize);
+    NodeId id = nodeCount++;
+    new (block(id)) Header{none, 0, isLeaf};
+    return id;
+}
+
+template <typename K, typename V, size_t Order>
+void FlatBPlusTree<K, V, Order>::clear() {
+    arena = std::vector<Line>();
+    nodeCount = 0;
+    root = none;
+}
+
+template <typename K, typename V, size_t Order>
+void FlatBPlusTree<K, V, Order>::bulkLoad(const std::vector<std::pair<K, V>>& sorted,
+                                   double fillFactor) {
+    clear();
+    if (sorted.empty()) {
+        return;
+    }
+    const size_t order = getOrder();
+
+    auto target = [&](size_t minimum) {
+        double wanted = static_cast<double>(order) * fillFactor;
+        return std::max(minimum, std::min(order, static_cast<size_t>(wanted)));
+    };
+    auto spread = [](size_t count, size_t per) {
+        size_t nodes = (count + per - 1) / per;
+        std::vector<size_t> sizes(nodes, count / nodes);
+        for (size_t i = 0; i < count % nodes; ++i)
+            ++sizes[i];
+        return sizes;
+    };
+
+    std::vector<size_t> leafSizes = spread(sorted.size(), target(1));
+    //Leaves plus a generous allowance for the internal levels.
+    arena.reserve((leafSizes.size() + leafSizes.size() / 2 + 1) *
+                  (layout().stride / lineSize));
+
+    //Leaf level, as in BPlusTree::bulkLoad.
+    std::vector<NodeId> level;
+    std::vector<K> levelMin;
+    NodeId previous = none;
+    size_t pos = 0;
+    for (size_t size : leafSizes) {
+        NodeId leaf = allocate(true);
+        K* ks = keys(leaf);
+        V* vs = values(leaf);
+        for (size_t i = 0; i < size; ++i, ++pos) {
+            ks[i] = sorted[pos].first;
+            vs[i] = sorted[pos].second;
+        }
+        header(leaf).count = static_cast<std::uint32_t>(size);
+        if (previous != none)
+            header(previous).next = leaf;
+        previous = leaf;
+        level.push_back(leaf);
+        levelMin.push_back(ks[0]);
+    }
+
+    //Internal levels, until one node is left.
+    while (level.size() > 1) {
+        size_t per = target(2);
+        size_t parents = (level.size() + per - 1) / per;
+        if (parents > 1 && level.size() < 2 * parents &&
+            (level.size() + parents - 2) / (parents - 1) <= order) {
+            per = (level.size() + parents - 2) / (parents - 1);
+        }
+
+        std::vector<NodeId> next;
+        std::vector<K> nextMin;
+        size_t child = 0;
+        for (size_t size : spread(level.size(), per)) {
+            NodeId node = allocate(false);
+            K* ks = keys(node);
+            NodeId* cs = children(node);
+            for (size_t i = 0; i < size; ++i, ++child) {
+                if (i > 0)
+                    ks[i - 1] = levelMin[child];
+                cs[i] = level[child];
+            }
+            header(node).count = static_cast<std::uint32_t>(size - 1);
+            nextMin.push_back(levelMin[child - size]);
+            next.push_back(node);
+        }
+        level = std::move(next);
+        levelMin = std::move(nextMin);
+    }
+    root = level.front();
+}
+
+//Leftmost leaf that could hold key, see BPlusTree::findFirstLeaf.
+template <typename K, typename V, size_t Order>
+typename FlatBPlusTree<K, V, Order>::NodeId FlatBPlusTree<K, V, Order>::findFirstLeaf(const K& key) {
+    NodeId id = root;
+    while (!header(id).isLeaf) {
+        size_t i = lowerBound(keys(id), header(id).count, key);
+        id = children(id)[i];
+    }
+    return id;
+}
+
+template <typename K, typename V, size_t Order>
+void FlatBPlusTree<K, V, Order>::insert(K key, V value) {
+    const size_t order = getOrder();
+    if (root == none) {
+        root = allocate(true);
+    }
+
+    //Descend as BPlusTree::findLeaf does, remembering the path so splits can
+    //be pushed up without parent links.
+    NodeId path[maxHeight];
+    size_t slot[maxHeight];
+    size_t depth = 0;
+    NodeId id = root;
+    while (!header(id).isLeaf) {
+        size_t i = upperBound(keys(id), header(id).count, key);
+        path[depth] = id;
+        slot[depth++] = i;
+        id = children(id)[i];
+    }
+
+    size_t count = header(id).count;
+    size_t index = upperBound(keys(id), count, key);
+    K* ks = keys(id);
+    V* vs = values(id);
+    std::memmove(ks + index + 1, ks + index, (count - index) * sizeof(K));
+    std::memmove(vs + index + 1, vs + index, (count - index) * sizeof(V));
+    ks[index] = key;
+    vs[index] = value;
+    header(id).count = static_cast<std::uint32_t>(++count);
+    if (count <= order) {
+        return;
+    }
+
+    //Split the leaf, moving its upper half into a new right sibling.
+    NodeId right = allocate(true);
+    size_t mid = count / 2;
+    std::memcpy(keys(right), keys(id) + mid, (count - mid) * sizeof(K));
+    std::memcpy(values(right), values(id) + mid, (count - mid) * sizeof(V));
+    header(right).count = static_cast<std::uint32_t>(count - mid);
+    header(right).next = header(id).next;
+    header(id).count = static_cast<std::uint32_t>(mid);
+    header(id).next = right;
+    K separator = keys(right)[0];
+
+    //Insert (separator, right) after the child that split, splitting
+    //internal nodes that reach `order` keys, as BPlusTree does.
+    while (depth > 0) {
+        NodeId parent = path[--depth];
+        size_t i = slot[depth];
+        count = header(parent).count;
+        ks = keys(parent);
+        NodeId* cs = children(parent);
+        std::memmove(ks + i + 1, ks + i, (count - i) * sizeof(K));
+        std::memmove(cs + i + 2, cs + i + 1, (count - i) * sizeof(NodeId));
+        ks[i] = separator;
+        cs[i + 1] = right;
+        header(parent).count = static_cast<std::uint32_t>(++count);
+        if (count < order) {
+            return;
+        }
+
+        NodeId sibling = allocate(false);
+        mid = count / 2;
+        separator = keys(parent)[mid];
+        std::memcpy(keys(sibling), keys(parent) + mid + 1,
+                    (count - mid - 1) * sizeof(K));
+        std::memcpy(children(sibling), children(parent) + mid + 1,
+                    (count - mid) * sizeof(NodeId));
+        header(sibling).count = static_cast<std::uint32_t>(count - mid - 1);
+        header(parent).count = static_cast<std::uint32_t>(mid);
+        right = sibling;
+    }
+
+    //The root split: grow the tree by one level.
+    NodeId newRoot = allocate(false);
+    keys(newRoot)[0] = separator;
+    children(newRoot)[0] = root;
+    children(newRoot)[1] = right;
+    header(newRoot).count = 1;
+    root = newRoot;
+}
+
+template <typename K, typename V, size_t Order>
+V* FlatBPlusTree<K, V, Order>::search(K key) {
+    if (root == none) {
+        return nullptr;
+    }
+    NodeId leaf = findFirstLeaf(key);
+    size_t idx = lowerBound(keys(leaf), header(leaf).count, key);
+    if (idx == header(leaf).count) {
+        leaf = header(leaf).next;
+        idx = 0;
+    }
+    if (leaf != none && idx < header(leaf).count && keys(leaf)[idx] == key) {
+        return &values(leaf)[idx];
+    }
+    return nullptr;
+}
+
+template <typename K, typename V, size_t Order>
+template <typename F>
+void FlatBPlusTree<K, V, Order>::visitRange(const K& low, const K& high, F&& visit) {
+    if (root == none) {
+        return;
+    }
+    NodeId leaf = findFirstLeaf(low);
+    size_t idx = lowerBound(keys(leaf), header(leaf).count, low);
+    while (leaf != none) {
+        const Header& h = header(leaf);
+        //Start pulling in the next leaf while this one is scanned.
+        if (h.next != none)
+            FLAT_BPLUS_PREFETCH(block(h.next));
+        const K* ks = keys(leaf);
+        V* vs = values(leaf);
+        for (size_t i = idx; i < h.count; ++i) {
+            if (ks[i] > high) {
+                return;
+            }
+            visit(vs[i]);
+        }
+        leaf = h.next;
+        idx = 0;
+    }
+}
+
+template <typename K, typename V, size_t Order>
+typename FlatBPlusTree<K, V, Order>::RangeCursor
+FlatBPlusTree<K, V, Order>::range(const K& low, const K& high) {
+    RangeCursor cursor;
+    cursor.tree = this;
+    cursor.high = high;
+    if (root != none) {
+        cursor.leaf = findFirstLeaf(low);
+        cursor.idx = lowerBound(keys(cursor.leaf), header(cursor.leaf).count, low);
+    }
+    return cursor;
+}
+
+template <typename K, typename V, size_t Order>
+V* FlatBPlusTree<K, V, Order>::RangeCursor::next() {
+    while (leaf != none) {
+        const Header& h = tree->header(leaf);
+        if (idx < h.count) {
+            if (tree->keys(leaf)[idx] > high) {
+                leaf = none;
+                return nullptr;
+            }
+            return &tree->values(leaf)[idx++];
+        }
+        if (h.next != none)
+            FLAT_BPLUS_PREFETCH(tree->block(h.next));
+        leaf = h.next;
+        idx = 0;
+    }
+    return nullptr;
+}
+
+template <typename K, typename V, size_t Order>
+size_t FlatBPlusTree<K, V, Order>::RangeCursor::skip(size_t n) {
+    size_t skipped = 0;
+    while (skipped < n && leaf != none) {
+        const Header& h = tree->header(leaf);
+        const K* ks = tree->keys(leaf);
+        if (idx < h.count && !(ks[h.count - 1] > high)) {
+            //The whole rest of this leaf matches.
+            size_t take = std::min<size_t>(h.count - idx, n - skipped);
+            idx += take;
+            skipped += take;
+        } else if (idx < h.count) {
+            //The range ends in this leaf.
+            if (ks[idx] > high) {
+                leaf = none;
+                break;
+            }
+            ++idx;
+            ++skipped;
+        } else {
+            leaf = h.next;
+            idx = 0;
+        }
+    }
+    return skipped;
+}
+
+template <typename K, typename V, size_t Order>
+size_t FlatBPlusTree<K, V, Order>::countRange(const K& low, const K& high) {
+    return range(low, high).skip(std::numeric_limits<size_t>::max());
+}
+
+template <typename K, typename V, size_t Order>
+std::vector<V*> FlatBPlusTree<K, V, Order>::getRange(const K& low, const K& high) {
+    std::vector<V*> out;
+    visitRange(low, high, [&](V& value) { out.push_back(&value); });
+    return out;
+}
+
+template <typename K, typename V, size_t Order>
+template <typename Rows>
+std::vector<typename Rows::value_type*> FlatBPlusTree<K, V, Order>::getRange(const K& low, const K& high, Rows& rows) {
+    std::vector<typename Rows::value_type*> out;
+    visitRange(low, high, [&](V& id) { out.push_back(&rows[id]); });
+    return out;
+}
+
+template <typename K, typename V, size_t Order>
+typename FlatBPlusTree<K, V, Order>::Stats FlatBPlusTree<K, V, Order>::getStats() const {
+    Stats stats;
+    if (root == none) {
+        return stats;
+    }
+    for (NodeId id = root;; id = children(id)[0]) {
+        ++stats.height;
+        if (header(id).isLeaf)
+            break;
+    }
+    for (NodeId id = 0; id < nodeCount; ++id) {
+        if (header(id).isLeaf) {
+            ++stats.leaves;
+            stats.keys += header(id).count;
+        } else {
+            ++stats.internals;
+        }
+    }
+    stats.bytes = arena.capacity() * sizeof(Line);
+    stats.leafFill = static_cast<double>(stats.keys) /
+                     (static_cast<double>(stats.leaves) * getOrder());
+    return stats;
+}
+
+extern template class FlatBPlusTree<float, RowId>;
+extern template class FlatBPlusTree<float, RowId, 3>;
+extern template class FlatBPlusTree<float, RowId, 21>;
+extern template class FlatBPlusTree<int, int>;
+extern template class FlatBPlusTree<int, int, 4>;
@@ -0,0 +1,4 @@
+#include "structures/morton_quadtree.hh"
+
+template class MortonQuadtree<sf::Vector2f>;
+template class MortonQuadtree<House>;
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "lib.hh"
+#include "structures/quadtree.hh"
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// A static quadtree packed into flat arrays. build() sorts the items by the
+// Morton (Z-order) code of their position, which puts every quadtree cell's
+// items in one contiguous run, and then stores the tree level by level as an
+// array of nodes, each naming its run of items and its block of children.
+//
+// A search walks node indices instead of pointers, tests positions from a
+// separate packed array instead of touching the items themselves, and takes a
+// node the circle covers entirely as one contiguous run. Node bounds are the
+// tight bounding box of their items, so empty space is pruned as well.
+//
+// Adding items means building again. Pointers returned by a search stay
+// valid until the next build.
+template <class T> class MortonQuadtree {
+  struct Node {
+    // Bounding box of the node's items, edges included.
+    float left, right, top, bottom;
+    std::uint32_t begin, end;
+    // Children are nodes[first_child, first_child + child_count).
+    std::uint32_t first_child;
+    std::uint32_t child_count;
+  };
+
+  // Positions are quantized to a 2^16 x 2^16 grid for the codes.
+  static constexpr unsigned grid_bits = 16;
+
+  std::vector<T> sorted;
+  std::vector<sf::Vector2f> positions;
+  std::vector<Node> nodes;
+  size_t leaf_size;
+  size_t depth = 0;
+
+  // Spreads the low 16 bits of v to the even bits.
+  static std::uint32_t spread_bits(std::uint32_t v) {
+    v &= 0xffff;
+    v = (v | (v << 8)) & 0x00ff00ff;
+    v = (v | (v << 4)) & 0x0f0f0f0f;
+    v = (v | (v << 2)) & 0x33333333;
+    v = (v | (v << 1)) & 0x55555555;
+    return v;
+  }
+
+public:
+  explicit MortonQuadtree(size_t leaf_size = 16) : leaf_size(leaf_size) {
+    if (leaf_size == 0)
+      throw std::invalid_argument("MortonQuadtree: leaf_size must be > 0");
+  }
+
+  MortonQuadtree(std::vector<T> items, size_t leaf_size = 16)
+      : MortonQuadtree(leaf_size) {
+    build(std::move(items));
+  }
+
+  // Replaces the contents with items. Throws std::length_error past 2^32 - 1
+  // items.
+  void build(std::vector<T> items) {
+    if (items.size() >= UINT32_MAX)
+      throw std::length_error("MortonQuadtree: too many items");
+    sorted.clear();
+    positions.clear();
+    nodes.clear();
+    depth = 0;
+    if (items.empty())
+      return;
+
+    // A square grid over the bounding box, so cells stay square.
+    sf::Vector2f low = get_position(items[0]), high = low;
+    for (const T &item : items) {
+      sf::Vector2f p = get_position(item);
+      low = {std::min(low.x, p.x), std::min(low.y, p.y)};
+      high = {std::max(high.x, p.x), std::max(high.y, p.y)};
+    }
+    float extent = std::max(high.x - low.x, high.y - low.y);
+    float scale = extent > 0 ? float(1u << grid_bits) / extent : 0.0f;
+    auto cell = [&](float offset) {
+      return std::min<std::uint32_t>(static_cast<std::uint32_t>(offset * scale),
+                                     (1u << grid_bits) - 1);
+    };
+
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> codes(items.size());
+    for (size_t i = 0; i < items.size(); i++) {
+      sf::Vector2f p = get_position(items[i]);
+      // y takes the odd bits, so each pair of bits is a Quadtree quadrant
+      // index: top left, top right, bottom left, bottom right.
+      codes[i] = {spread_bits(cell(p.x - low.x)) |
+                      (spread_bits(cell(p.y - low.y)) << 1),
+                  static_cast<std::uint32_t>(i)};
+    }
+    std::sort(codes.begin(), codes.end());
+
+    sorted.reserve(items.size());
+    positions.reserve(items.size());
+    for (const auto &code : codes) {
+      sorted.push_back(std::move(items[code.second]));
+      positions.push_back(get_position(sorted.back()));
+    }
+    items = {};
+
+    // Breadth first, so each node's children land next to each other. A
+    // node at level l splits on bits 2 * (grid_bits - 1 - l) and up.
+    nodes.push_back({0, 0, 0, 0, 0, static_cast<std::uint32_t>(codes.size()),
+                     0, 0});
+    std::vector<unsigned> levels = {0};
+    for (size_t i = 0; i < nodes.size(); i++) {
+      Node node = nodes[i];
+      auto first = positions.begin() + node.begin;
+      auto last = positions.begin() + node.end;
+      auto [min_x, max_x] = std::minmax_element(
+          first, last, [](sf::Vector2f a, sf::Vector2f b) { return a.x < b.x; });
+      auto [min_y, max_y] = std::minmax_element(
+          first, last, [](sf::Vector2f a, sf::Vector2f b) { return a.y < b.y; });
+      node.left = min_x->x;
+      node.right = max_x->x;
+      node.top = min_y->y;
+      node.bottom = max_y->y;
+
+      unsigned level = levels[i];
+      depth = std::max<size_t>(depth, level);
+      if (node.end - node.begin > leaf_size && level < grid_bits) {
+        unsigned shift = 2 * (grid_bits - 1 - level);
+        node.first_child = static_cast<std::uint32_t>(nodes.size());
+        std::uint32_t begin = node.begin;
+        while (begin < node.end) {
+          std::uint32_t quadrant = (codes[begin].first >> shift) & 3;
+          auto end = std::partition_point(
+              codes.begin() + begin, codes.begin() + node.end,
+              [&](const auto &code) {
+                return ((code.first >> shift) & 3) == quadrant;
+              });
+          std::uint32_t stop = static_cast<std::uint32_t>(end - codes.begin());
+          nodes.push_back({0, 0, 0, 0, begin, stop, 0, 0});
+          levels.push_back(level + 1);
+          node.child_count++;
+          begin = stop;
+        }
+      }
+      nodes[i] = node;
+    }
+  }
+
+  std::vector<T *> find_in_radius(sf::Vector2f center, float radius) {
+    std::vector<T *> result;
+    if (nodes.empty())
+      return result;
+    float radius_sq = radius * radius;
+    std::vector<std::uint32_t> stack = {0};
+    while (!stack.empty()) {
+      const Node &node = nodes[stack.back()];
+      stack.pop_back();
+
+      float dx = std::max(0.0f, std::max(center.x - node.right,
+                                         node.left - center.x));
+      float dy = std::max(0.0f, std::max(center.y - node.bottom,
+                                         node.top - center.y));
+      if (dx * dx + dy * dy > radius_sq)
+        continue;
+
+      float fx = std::max(center.x - node.left, node.right - center.x);
+      float fy = std::max(center.y - node.top, node.bottom - center.y);
+      if (fx * fx + fy * fy <= radius_sq) {
+        for (std::uint32_t i = node.begin; i < node.end; i++)
+          result.push_back(&sorted[i]);
+      } else if (node.child_count == 0) {
+        for (std::uint32_t i = node.begin; i < node.end; i++) {
+          if ((positions[i] - center).lengthSquared() <= radius_sq)
+            result.push_back(&sorted[i]);
+        }
+      } else {
+        for (std::uint32_t c = node.child_count; c-- > 0;)
+          stack.push_back(node.first_child + c);
+      }
+    }
+    return result;
+  }
+
+  size_t size() const { return sorted.size(); }
+  // The items in Morton order.
+  const std::vector<T> &items() const { return sorted; }
+
+  QuadtreeStats stats() const {
+    QuadtreeStats stats;
+    stats.nodes = nodes.size();
+    stats.items = sorted.size();
+    stats.bytes = nodes.capacity() * sizeof(Node) +
+                  sorted.capacity() * sizeof(T) +
+                  positions.capacity() * sizeof(sf::Vector2f);
+    stats.max_depth = depth;
+    return stats;
+  }
+};
+
+extern template class MortonQuadtree<sf::Vector2f>;
+extern template class MortonQuadtree<House>;
@@ -0,0 +1,157 @@
+#pragma once
+#include <algorithm>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define NODE_SEARCH_AVX2 1
+#endif
+
+// Key search within one sorted B+ tree node.
+//
+// node_lower_bound(keys, n, key) is the number of keys < key and
+// node_upper_bound(keys, n, key) the number of keys <= key, i.e. the same
+// positions std::lower_bound / std::upper_bound would return.
+//
+// Arithmetic keys take branch-free paths: nodes of up to
+// node_search_linear_max keys are counted with one compare per key (eight
+// at a time with AVX2 for float and 32-bit int keys), bigger nodes use a
+// binary search whose loop only depends on the node size. Any other key
+// type falls back to std::lower_bound / std::upper_bound.
+
+inline constexpr size_t node_search_linear_max = 32;
+
+template <typename K>
+size_t node_count_less(const K* keys, size_t n, K key) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i)
+        count += keys[i] < key;
+    return count;
+}
+
+template <typename K>
+size_t node_count_not_greater(const K* keys, size_t n, K key) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i)
+        count += !(key < keys[i]);
+    return count;
+}
+
+#ifdef NODE_SEARCH_AVX2
+inline size_t node_popcount8(int mask) {
+    return std::bitset<8>(static_cast<unsigned>(mask)).count();
+}
+
+inline size_t node_count_less(const float* keys, size_t n, float key) {
+    const __m256 needle = _mm256_set1_ps(key);
+    size_t count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 lt = _mm256_cmp_ps(_mm256_loadu_ps(keys + i), needle, _CMP_LT_OQ);
+        count += node_popcount8(_mm256_movemask_ps(lt));
+    }
+    for (; i < n; ++i)
+        count += keys[i] < key;
+    return count;
+}
+
+inline size_t node_count_not_greater(const float* keys, size_t n, float key) {
+    const __m256 needle = _mm256_set1_ps(key);
+    size_t count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 le = _mm256_cmp_ps(_mm256_loadu_ps(keys + i), needle, _CMP_LE_OQ);
+        count += node_popcount8(_mm256_movemask_ps(le));
+    }
+    for (; i < n; ++i)
+        count += keys[i] <= key;
+    return count;
+}
+
+inline size_t node_count_less(const std::int32_t* keys, size_t n,
+                              std::int32_t key) {
+    const __m256i needle = _mm256_set1_epi32(key);
+    size_t count = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        __m256i lt = _mm256_cmpgt_epi32(needle, v);
+        count += node_popcount8(_mm256_movemask_ps(_mm256_castsi256_ps(lt)));
+    }
+    for (; i < n; ++i)
+        count += keys[i] < key;
+    return count;
+}
+
+inline size_t node_count_not_greater(const std::int32_t* keys, size_t n,
+                                     std::int32_t key) {
+    const __m256i needle = _mm256_set1_epi32(key);
+    size_t greater = 0, i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+        __m256i gt = _mm256_cmpgt_epi32(v, needle);
+        greater += node_popcount8(_mm256_movemask_ps(_mm256_castsi256_ps(gt)));
+    }
+    for (; i < n; ++i)
+        greater += keys[i] > key;
+    return n - greater;
+}
+#endif
+
+// Number of keys for which `before(keys[i], key)` holds, assuming they form
+// a prefix of the node. The loop runs log2(n) times whatever the key is and
+// the compare only feeds a conditional move.
+template <typename K, typename Before>
+size_t node_partition(const K* keys, size_t n, K key, Before before) {
+    if (n == 0)
+        return 0;
+    const K* base = keys;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = before(base[half - 1], key) ? base + half : base;
+        n -= half;
+    }
+    return static_cast<size_t>(base - keys) + before(*base, key);
+}
+
+// node_lower_bound / node_upper_bound for nodes with room for Capacity keys.
+// Every slot is compared and those at or past n are masked off, so the loop
+// has a fixed trip count the compiler can unroll and vectorize. Slots past n
+// must hold initialized keys.
+template <size_t Capacity, typename K>
+size_t node_lower_bound_fixed(const K* keys, size_t n, K key) {
+    size_t count = 0;
+    for (size_t i = 0; i < Capacity; ++i)
+        count += (i < n) & (keys[i] < key);
+    return count;
+}
+
+template <size_t Capacity, typename K>
+size_t node_upper_bound_fixed(const K* keys, size_t n, K key) {
+    size_t count = 0;
+    for (size_t i = 0; i < Capacity; ++i)
+        count += (i < n) & !(key < keys[i]);
+    return count;
+}
+
+template <typename K>
+size_t node_lower_bound(const K* keys, size_t n, const K& key) {
+    if constexpr (std::is_arithmetic_v<K>) {
+        if (n <= node_search_linear_max)
+            return node_count_less(keys, n, key);
+        return node_partition(keys, n, key, [](K a, K b) { return a < b; });
+    } else {
+        return std::lower_bound(keys, keys + n, key) - keys;
+    }
+}
+
+template <typename K>
+size_t node_upper_bound(const K* keys, size_t n, const K& key) {
+    if constexpr (std::is_arithmetic_v<K>) {
+        if (n <= node_search_linear_max)
+            return node_count_not_greater(keys, n, key);
+        return node_partition(keys, n, key, [](K a, K b) { return !(b < a); });
+    } else {
+        return std::upper_bound(keys, keys + n, key) - keys;
+    }
+}
@@ -0,0 +1,4 @@
+#include "paged_bplustree.hh"
+
+template class PagedBPlusTree<float, RowId>;
+template class PagedBPlusTree<int, int>;
@@ -0,0 +1,458 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "lib.hh"
+#include "io/buffer_pool.hh"
+#include "structures/node_search.hh"
+
+// A B+ tree that lives in a file, one node per page, for data sets larger
+// than memory. It behaves like BPlusTree (leaves hold up to `order` keys,
+// duplicate keys are allowed, getRange returns every match in key order),
+// except that internal nodes also hold up to `order` keys, so `order + 1`
+// children where BPlusTree stops at `order`. Nodes are read through a
+// BufferPool of a fixed number of frames, so memory use stays the same
+// however big the file grows and a search reads only the pages on its path.
+//
+// Page 0 describes the tree; every other page is a node: a Header, then the
+// keys, then the values (leaves) or child page ids (internal nodes). Each
+// page has room for one key and one child more than a node keeps, so an
+// insert can overflow a node before it is split, as in FlatBPlusTree. The
+// file is native byte order, and opening a file written for keys or values
+// of other sizes fails.
+//
+// Results are copied out of the pages, since a page may be evicted as soon
+// as the tree moves on. Not thread-safe.
+template <typename K, typename V>
+class PagedBPlusTree {
+    static_assert(std::is_trivially_copyable_v<K> &&
+                      std::is_trivially_copyable_v<V>,
+                  "PagedBPlusTree stores keys and values as raw bytes");
+
+public:
+    // Biggest order whose nodes fit in one page.
+    static constexpr size_t maxOrder();
+    // A split pins the node and its new sibling at once; the parent is
+    // fetched after both are released.
+    static constexpr size_t minPoolPages = 2;
+
+    // Opens the tree in filename, or starts an empty one if the file is
+    // missing or empty. order 0 keeps the file's order, or uses maxOrder()
+    // for a new tree. Throws std::runtime_error if the file holds anything
+    // else, and std::invalid_argument for an order below 3, above maxOrder()
+    // or different from the file's, or fewer than minPoolPages pages.
+    explicit PagedBPlusTree(const std::string& filename, size_t poolPages = 256,
+                            size_t order = 0);
+    // Writes every change back to the file.
+    ~PagedBPlusTree();
+
+    PagedBPlusTree(const PagedBPlusTree&) = delete;
+    PagedBPlusTree& operator=(const PagedBPlusTree&) = delete;
+
+    // Replaces the contents, as BPlusTree::bulkLoad: packed leaves, then each
+    // internal level bottom-up, filling each node to fillFactor of its
+    // capacity. Pages are written in key order.
+    void bulkLoad(const std::vector<std::pair<K, V>>& sorted,
+                  double fillFactor = 1.0);
+    void insert(K key, V value);
+    // The value of some entry with this key.
+    std::optional<V> search(K key);
+    std::vector<V> getRange(const K& low, const K& high);
+    // For trees whose values are row ids: the rows they point at in `rows`.
+    template <typename Rows>
+    std::vector<typename Rows::value_type*> getRange(const K& low, const K& high, Rows& rows);
+    // getRange(low, high).size() without building the vector.
+    size_t countRange(const K& low, const K& high);
+
+    size_t size() const { return meta.entries; }
+    size_t getOrder() const { return meta.order; }
+    size_t height() const { return meta.height; }
+    size_t pageCount() const { return pool.page_count(); }
+
+    // Writes every change back to the file.
+    void flush();
+    const BufferPool::Stats& poolStats() const { return pool.stats(); }
+    void resetPoolStats() { pool.reset_stats(); }
+
+private:
+    static constexpr char magic[4] = {'R', 'H', 'B', 'P'};
+    static constexpr std::uint32_t version = 1;
+    static constexpr std::uint32_t byteOrder = 0x01020304;
+    // Page 0 is the meta page, so no node has id 0.
+    static constexpr PageId none = 0;
+
+    struct Meta {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t keySize;
+        std::uint32_t valueSize;
+        std::uint32_t order;
+        PageId root;
+        std::uint32_t height;  // levels, 1 when the root is a leaf
+        std::uint64_t entries;
+        std::uint64_t pages;
+    };
+    struct Header {
+        PageId next;  // next leaf, or none
+        std::uint32_t count;  // keys in use
+        std::uint32_t isLeaf;
+    };
+
+    static constexpr size_t roundUp(size_t n, size_t to) { return (n + to - 1) / to * to; }
+    static constexpr size_t keysOffset = roundUp(sizeof(Header), alignof(K));
+    static constexpr size_t slotAlign = std::max(alignof(V), alignof(PageId));
+    static constexpr size_t slotsOffset(size_t order) {
+        return roundUp(keysOffset + (order + 1) * sizeof(K), slotAlign);
+    }
+    static constexpr bool fits(size_t order) {
+        return slotsOffset(order) + (order + 2) * std::max(sizeof(V), sizeof(PageId)) <= page_size;
+    }
+
+    static size_t checkedPoolPages(size_t poolPages) {
+        if (poolPages < minPoolPages)
+            throw std::invalid_argument("PagedBPlusTree: pool needs at least minPoolPages pages");
+        return poolPages;
+    }
+
+    BufferPool pool;
+    Meta meta{};
+    size_t slots = 0;  // slotsOffset(meta.order)
+
+    static Header& header(char* page) { return *reinterpret_cast<Header*>(page); }
+    static const Header& header(const char* page) { return *reinterpret_cast<const Header*>(page); }
+    static K* keys(char* page) { return reinterpret_cast<K*>(page + keysOffset); }
+    static const K* keys(const char* page) { return reinterpret_cast<const K*>(page + keysOffset); }
+    V* values(char* page) const { return reinterpret_cast<V*>(page + slots); }
+    const V* values(const char* page) const { return reinterpret_cast<const V*>(page + slots); }
+    PageId* children(char* page) const { return reinterpret_cast<PageId*>(page + slots); }
+    const PageId* children(const char* page) const { return reinterpret_cast<const PageId*>(page + slots); }
+
+    // The first leaf that can hold key (equal keys go left), as in BPlusTree.
+    PageId findFirstLeaf(const K& key);
+    PageRef newNode(bool isLeaf);
+    void writeMeta();
+    // Visits the values with low <= key <= high in key order.
+    template <typename F>
+    void visitRange(const K& low, const K& high, F&& visit);
+};
+
+template <typename K, typename V>
+constexpr size_t PagedBPlusTree<K, V>::maxOrder() {
+    size_t order = 3;
+    while (fits(order + 1))
+        ++order;
+    return order;
+}
+
+template <typename K, typename V>
+PagedBPlusTree<K, V>::PagedBPlusTree(const std::string& filename, size_t poolPages, size_t order)
+    : pool(filename, checkedPoolPages(poolPages)) {
+    static_assert(fits(3), "PagedBPlusTree: keys and values too big for a page");
+    if (order != 0 && (order < 3 || order > maxOrder()))
+        throw std::invalid_argument("PagedBPlusTree: order must be between 3 and maxOrder()");
+
+    if (pool.page_count() == 0) {
+        std::memcpy(meta.magic, magic, sizeof(magic));
+        meta.version = version;
+        meta.byteOrder = byteOrder;
+        meta.keySize = sizeof(K);
+        meta.valueSize = sizeof(V);
+        meta.order = static_cast<std::uint32_t>(order ? order : maxOrder());
+        meta.root = none;
+        pool.allocate();
+        writeMeta();
+    } else {
+        PageRef page = pool.fetch(0);
+        std::memcpy(&meta, page.data(), sizeof(meta));
+        if (std::memcmp(meta.magic, magic, sizeof(magic)) != 0 || meta.version != version ||
+            meta.byteOrder != byteOrder || meta.keySize != sizeof(K) ||
+            meta.valueSize != sizeof(V) || meta.order < 3 || meta.order > maxOrder() ||
+            meta.pages > pool.page_count())
+            throw std::runtime_error("PagedBPlusTree: " + filename + " is not a tree of this type");
+        if (order != 0 && order != meta.order)
+            throw std::invalid_argument("PagedBPlusTree: order differs from the file's");
+        //Pages past meta.pages were never committed; reuse them.
+        pool.truncate(meta.pages);
+    }
+    slots = slotsOffset(meta.order);
+}
+
+template <typename K, typename V>
+PagedBPlusTree<K, V>::~PagedBPlusTree() {
+    try {
+        writeMeta();
+    } catch (...) {
+        //The pool still writes back what it can.
+    }
+}
+
+template <typename K, typename V>
+void PagedBPlusTree<K, V>::writeMeta() {
+    meta.pages = pool.page_count();
+    PageRef page = pool.fetch(0);
+    std::memcpy(page.edit(), &meta, sizeof(meta));
+}
+
+template <typename K, typename V>
+void PagedBPlusTree<K, V>::flush() {
+    writeMeta();
+    pool.flush();
+}
+
+template <typename K, typename V>
+PageRef PagedBPlusTree<K, V>::newNode(bool isLeaf) {
+    PageRef page = pool.allocate();
+    Header& h = header(page.edit());
+    h.next = none;
+    h.count = 0;
+    h.isLeaf = isLeaf;
+    return page;
+}
+
+template <typename K, typename V>
+PageId PagedBPlusTree<K, V>::findFirstLeaf(const K& key) {
+    PageId id = meta.root;
+    for (size_t level = 1; level < meta.height; ++level) {
+        PageRef page = pool.fetch(id);
+        size_t i = node_lower_bound(keys(page.data()), header(page.data()).count, key);
+        id = children(page.data())[i];
+    }
+    return id;
+}
+
+template <typename K, typename V>
+void PagedBPlusTree<K, V>::bulkLoad(const std::vector<std::pair<K, V>>& sorted, double fillFactor) {
+    pool.truncate(1);
+    meta.root = none;
+    meta.height = 0;
+    meta.entries = sorted.size();
+    if (sorted.empty()) {
+        writeMeta();
+        return;
+    }
+
+    //Spread entries evenly over as few nodes as fillFactor allows, so the
+    //last node is never left nearly empty.
+    auto nodesFor = [](size_t items, size_t perNode) {
+        return (items + perNode - 1) / perNode;
+    };
+    fillFactor = std::clamp(fillFactor, 0.0, 1.0);
+    size_t order = meta.order;
+    size_t perLeaf = std::max<size_t>(1, static_cast<size_t>(std::floor(fillFactor * order)));
+
+    //(first key, page) of every node on the level being built.
+    std::vector<std::pair<K, PageId>> level;
+    size_t leaves = nodesFor(sorted.size(), perLeaf);
+    PageRef previous;
+    size_t next = 0;
+    for (size_t n = 0; n < leaves; ++n) {
+        size_t end = sorted.size() * (n + 1) / leaves;
+        PageRef leaf = newNode(true);
+        char* page = leaf.edit();
+        for (size_t i = next; i < end; ++i) {
+            keys(page)[i - next] = sorted[i].first;
+            values(page)[i - next] = sorted[i].second;
+        }
+        header(page).count = static_cast<std::uint32_t>(end - next);
+        if (n > 0)
+            header(previous.edit()).next = leaf.id();
+        level.emplace_back(sorted[next].first, leaf.id());
+        previous = std::move(leaf);
+        next = end;
+    }
+    previous.release();
+    meta.height = 1;
+
+    size_t perNode = std::max<size_t>(2, static_cast<size_t>(std::floor(fillFactor * (order + 1))));
+    while (level.size() > 1) {
+        std::vector<std::pair<K, PageId>> parents;
+        size_t nodes = nodesFor(level.size(), perNode);
+        //With a small fanout, spreading can leave a node with one child; take
+        //one node fewer if the rest still fit, as BPlusTree::bulkLoad does.
+        if (nodes > 1 && level.size() < 2 * nodes &&
+            nodesFor(level.size(), nodes - 1) <= order + 1) {
+            --nodes;
+        }
+        next = 0;
+        for (size_t n = 0; n < nodes; ++n) {
+            size_t end = level.size() * (n + 1) / nodes;
+            PageRef node = newNode(false);
+            char* page = node.edit();
+            for (size_t c = next; c < end; ++c) {
+                children(page)[c - next] = level[c].second;
+                if (c > next)
+                    keys(page)[c - next - 1] = level[c].first;
+            }
+            header(page).count = static_cast<std::uint32_t>(end - next - 1);
+            parents.emplace_back(level[next].first, node.id());
+            next = end;
+        }
+        level = std::move(parents);
+        ++meta.height;
+    }
+    meta.root = level[0].second;
+    writeMeta();
+}
+
+template <typename K, typename V>
+void PagedBPlusTree<K, V>::insert(K key, V value) {
+    if (meta.root == none) {
+        meta.root = newNode(true).id();
+        meta.height = 1;
+    }
+
+    //Descend as BPlusTree::findLeaf does (equal keys go right), remembering
+    //the path so splits can be pushed up it. Only one page is pinned at a
+    //time; parents are fetched again if a split reaches them.
+    std::vector<std::pair<PageId, size_t>> path;
+    PageId id = meta.root;
+    for (size_t level = 1; level < meta.height; ++level) {
+        PageRef page = pool.fetch(id);
+        size_t i = node_upper_bound(keys(page.data()), header(page.data()).count, key);
+        path.emplace_back(id, i);
+        id = children(page.data())[i];
+    }
+
+    PageRef leaf = pool.fetch(id);
+    char* page = leaf.edit();
+    size_t count = header(page).count;
+    size_t index = node_upper_bound(keys(page), count, key);
+    std::memmove(keys(page) + index + 1, keys(page) + index, (count - index) * sizeof(K));
+    std::memmove(values(page) + index + 1, values(page) + index, (count - index) * sizeof(V));
+    keys(page)[index] = key;
+    values(page)[index] = value;
+    header(page).count = static_cast<std::uint32_t>(++count);
+    ++meta.entries;
+    if (count <= meta.order)
+        return;
+
+    //Split the leaf, keeping the right half in a new page after it.
+    PageRef right = newNode(true);
+    char* rightPage = right.edit();
+    size_t mid = count / 2;
+    std::memcpy(keys(rightPage), keys(page) + mid, (count - mid) * sizeof(K));
+    std::memcpy(values(rightPage), values(page) + mid, (count - mid) * sizeof(V));
+    header(rightPage).count = static_cast<std::uint32_t>(count - mid);
+    header(rightPage).next = header(page).next;
+    header(page).count = static_cast<std::uint32_t>(mid);
+    header(page).next = right.id();
+    K separator = keys(rightPage)[0];
+    PageId left = leaf.id();
+    PageId added = right.id();
+    leaf.release();
+    right.release();
+
+    while (!path.empty()) {
+        auto [parentId, i] = path.back();
+        path.pop_back();
+        PageRef parent = pool.fetch(parentId);
+        page = parent.edit();
+        count = header(page).count;
+        std::memmove(keys(page) + i + 1, keys(page) + i, (count - i) * sizeof(K));
+        std::memmove(children(page) + i + 2, children(page) + i + 1, (count - i) * sizeof(PageId));
+        keys(page)[i] = separator;
+        children(page)[i + 1] = added;
+        header(page).count = static_cast<std::uint32_t>(++count);
+        if (count <= meta.order)
+            return;
+
+        //Split the internal node; its middle key moves up.
+        PageRef sibling = newNode(false);
+        char* siblingPage = sibling.edit();
+        mid = count / 2;
+        separator = keys(page)[mid];
+        std::memcpy(keys(siblingPage), keys(page) + mid + 1, (count - mid - 1) * sizeof(K));
+        std::memcpy(children(siblingPage), children(page) + mid + 1, (count - mid) * sizeof(PageId));
+        header(siblingPage).count = static_cast<std::uint32_t>(count - mid - 1);
+        header(page).count = static_cast<std::uint32_t>(mid);
+        left = parentId;
+        added = sibling.id();
+    }
+
+    //The root split: grow the tree by one level.
+    PageRef root = newNode(false);
+    page = root.edit();
+    keys(page)[0] = separator;
+    children(page)[0] = left;
+    children(page)[1] = added;
+    header(page).count = 1;
+    meta.root = root.id();
+    ++meta.height;
+}
+
+template <typename K, typename V>
+std::optional<V> PagedBPlusTree<K, V>::search(K key) {
+    std::optional<V> found;
+    visitRange(key, key, [&](const V& value) {
+        found = value;
+        return false;
+    });
+    return found;
+}
+
+template <typename K, typename V>
+template <typename F>
+void PagedBPlusTree<K, V>::visitRange(const K& low, const K& high, F&& visit) {
+    if (meta.root == none || high < low)
+        return;
+    PageRef leaf = pool.fetch(findFirstLeaf(low));
+    size_t i = node_lower_bound(keys(leaf.data()), header(leaf.data()).count, low);
+    while (true) {
+        const char* page = leaf.data();
+        size_t count = header(page).count;
+        for (; i < count; ++i) {
+            if (high < keys(page)[i])
+                return;
+            if (!visit(values(page)[i]))
+                return;
+        }
+        PageId next = header(page).next;
+        if (next == none)
+            return;
+        leaf = pool.fetch(next);
+        i = 0;
+    }
+}
+
+template <typename K, typename V>
+std::vector<V> PagedBPlusTree<K, V>::getRange(const K& low, const K& high) {
+    std::vector<V> out;
+    visitRange(low, high, [&](const V& value) {
+        out.push_back(value);
+        return true;
+    });
+    return out;
+}
+
+template <typename K, typename V>
+template <typename Rows>
+std::vector<typename Rows::value_type*> PagedBPlusTree<K, V>::getRange(const K& low, const K& high, Rows& rows) {
+    std::vector<typename Rows::value_type*> out;
+    visitRange(low, high, [&](const V& id) {
+        out.push_back(&rows[id]);
+        return true;
+    });
+    return out;
+}
+
+template <typename K, typename V>
+size_t PagedBPlusTree<K, V>::countRange(const K& low, const K& high) {
+    size_t count = 0;
+    visitRange(low, high, [&](const V&) {
+        ++count;
+        return true;
+    });
+    return count;
+}
+
+extern template class PagedBPlusTree<float, RowId>;
+extern template class PagedBPlusTree<int, int>;
@@ -2,8 +2,13 @@
 
 #include "lib.hh"
 #include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <functional>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <queue>
+#include <type_traits>
 #include <vector>
 
 template <typename T> sf::Vector2f get_position(const T &value);
@@ -19,11 +24,58 @@ template <> inline sf::Vector2f get_position<House>(const House &value) {
   return value.position;
 }
 
-template <class T> class Quadtree {
-  std::unique_ptr<Quadtree<T>> top_left{nullptr};
-  std::unique_ptr<Quadtree<T>> top_right{nullptr};
-  std::unique_ptr<Quadtree<T>> bottom_left{nullptr};
-  std::unique_ptr<Quadtree<T>> bottom_right{nullptr};
+// Shape and memory use of a tree. bytes counts node objects and item
+// storage, not allocator overhead.
+struct QuadtreeStats {
+  size_t nodes = 0;
+  size_t items = 0;
+  size_t max_depth = 0;
+  size_t bytes = 0;
+};
+
+// Count, sum, min and max of a set of values.
+struct QuadtreeAggregate {
+  size_t count = 0;
+  double sum = 0;
+  float min = std::numeric_limits<float>::infinity();
+  float max = -std::numeric_limits<float>::infinity();
+
+  void add(float value) {
+    count++;
+    sum += value;
+    min = std::min(min, value);
+    max = std::max(max, value);
+  }
+
+  void add(const QuadtreeAggregate &other) {
+    count += other.count;
+    sum += other.sum;
+    min = std::min(min, other.min);
+    max = std::max(max, other.max);
+  }
+
+  double mean() const { return count ? sum / count : 0.0; }
+};
+
+// Where a Quadtree keeps the aggregate of its subtree; empty without a field,
+// so trees that don't aggregate pay nothing for it.
+template <class Field> struct QuadtreeAggregateSlot {
+  QuadtreeAggregate subtree;
+};
+template <> struct QuadtreeAggregateSlot<void> {};
+
+// Field, if given, is a default constructible function object returning the
+// float to aggregate for an item, e.g. its price. Every node then keeps the
+// aggregate of its subtree, so aggregate_in_radius takes subtrees the circle
+// covers entirely in O(1).
+template <class T, class Field = void>
+class Quadtree : QuadtreeAggregateSlot<Field> {
+  static constexpr bool has_field = !std::is_void_v<Field>;
+
+  std::unique_ptr<Quadtree> top_left{nullptr};
+  std::unique_ptr<Quadtree> top_right{nullptr};
+  std::unique_ptr<Quadtree> bottom_left{nullptr};
+  std::unique_ptr<Quadtree> bottom_right{nullptr};
 
   float left = 0.0f;
   float right = 1.0f;
@@ -37,7 +89,7 @@ template <class T> class Quadtree {
     bool is_left = target.x < left;
     bool is_up = target.y < top;
 
-    std::unique_ptr<Quadtree<T>> new_child{new Quadtree<T>};
+    std::unique_ptr<Quadtree> new_child{new Quadtree};
     new_child->top_left.swap(top_left);
     new_child->top_right.swap(top_right);
     new_child->bottom_left.swap(bottom_left);
@@ -59,6 +111,9 @@ template <class T> class Quadtree {
       bottom += bottom - top;
 
     new_child->held.swap(held);
+    // The new child holds everything this node held; the total is unchanged.
+    if constexpr (has_field)
+      new_child->subtree = this->subtree;
 
     // Set child to correct position
     if (is_left && is_up)
@@ -85,7 +140,7 @@ template <class T> class Quadtree {
     if (pos.y < mid_y) {
       if (pos.x < mid_x) {
         if (!top_left)
-          top_left = std::make_unique<Quadtree<T>>();
+          top_left = std::make_unique<Quadtree>();
         top_left->left = left;
         top_left->right = mid_x;
         top_left->top = top;
@@ -93,7 +148,7 @@ template <class T> class Quadtree {
         top_left->add_item(std::move(item));
       } else {
         if (!top_right)
-          top_right = std::make_unique<Quadtree<T>>();
+          top_right = std::make_unique<Quadtree>();
         top_right->left = mid_x;
         top_right->right = right;
         top_right->top = top;
@@ -103,7 +158,7 @@ template <class T> class Quadtree {
     } else {
       if (pos.x < mid_x) {
         if (!bottom_left)
-          bottom_left = std::make_unique<Quadtree<T>>();
+          bottom_left = std::make_unique<Quadtree>();
         bottom_left->left = left;
         bottom_left->right = mid_x;
         bottom_left->top = mid_y;
@@ -111,7 +166,7 @@ template <class T> class Quadtree {
         bottom_left->add_item(std::move(item));
       } else {
         if (!bottom_right)
-          bottom_right = std::make_unique<Quadtree<T>>();
+          bottom_right = std::make_unique<Quadtree>();
         bottom_right->left = mid_x;
         bottom_right->right = right;
         bottom_right->top = mid_y;
@@ -121,13 +176,67 @@ template <class T> class Quadtree {
     }
   }
 
+  // Squared distance from point to the nearest point of this node's bounds.
+  float distance_sq_to(sf::Vector2f point) const {
+    float dx = std::max(0.0f, std::max(point.x - right, left - point.x));
+    float dy = std::max(0.0f, std::max(point.y - bottom, top - point.y));
+    return dx * dx + dy * dy;
+  }
+
+  void add_all(std::vector<T *> &result) {
+    if (held)
+      result.push_back(held.get());
+    for (auto *child : {&top_left, &top_right, &bottom_left, &bottom_right}) {
+      if (*child)
+        (*child)->add_all(result);
+    }
+  }
+
+  void find_in_rect_helper(float rect_left, float rect_right, float rect_top,
+                           float rect_bottom, std::vector<T *> &result) {
+    if (rect_right < left || rect_left > right || rect_bottom < top ||
+        rect_top > bottom)
+      return;
+    // Bounds are half open, so a node ending at the rect's edge is inside.
+    if (rect_left <= left && right <= rect_right && rect_top <= top &&
+        bottom <= rect_bottom) {
+      add_all(result);
+      return;
+    }
+
+    if (held) {
+      sf::Vector2f pos = get_position(*held);
+      if (pos.x >= rect_left && pos.x <= rect_right && pos.y >= rect_top &&
+          pos.y <= rect_bottom)
+        result.push_back(held.get());
+    }
+    for (auto *child : {&top_left, &top_right, &bottom_left, &bottom_right}) {
+      if (*child)
+        (*child)->find_in_rect_helper(rect_left, rect_right, rect_top,
+                                      rect_bottom, result);
+    }
+  }
+
+  void stats_helper(QuadtreeStats &stats, size_t depth) const {
+    stats.nodes++;
+    stats.max_depth = std::max(stats.max_depth, depth);
+    stats.bytes += sizeof(*this);
+    if (held) {
+      stats.items++;
+      stats.bytes += sizeof(T);
+    }
+    for (const auto *child : {&top_left, &top_right, &bottom_left,
+                              &bottom_right}) {
+      if (*child)
+        (*child)->stats_helper(stats, depth + 1);
+    }
+  }
+
   void find_in_radius_helper(sf::Vector2f center, float radius,
                              std::vector<T *> &result) {
     // We want to early return if the search circle is out of range. (Otherwise
     // we visit every single node)
-    float dx = std::max(0.0f, std::max(center.x - right, left - center.x));
-    float dy = std::max(0.0f, std::max(center.y - bottom, top - center.y));
-    if (dx * dx + dy * dy > radius * radius) {
+    if (distance_sq_to(center) > radius * radius) {
       return; // Early exit if outside radius
     }
 
@@ -154,6 +263,31 @@ template <class T> class Quadtree {
     }
   }
 
+  template <class F>
+  void aggregate_in_radius_helper(sf::Vector2f center, float radius,
+                                  QuadtreeAggregate &result) const {
+    if (distance_sq_to(center) > radius * radius)
+      return;
+
+    // Farthest corner in range: the whole subtree is, so take its total.
+    float fx = std::max(center.x - left, right - center.x);
+    float fy = std::max(center.y - top, bottom - center.y);
+    if (fx * fx + fy * fy <= radius * radius) {
+      result.add(this->subtree);
+      return;
+    }
+
+    if (held && (get_position(*held) - center).lengthSquared() <=
+                    radius * radius)
+      result.add(F{}(*held));
+    for (const auto *child : {&top_left, &top_right, &bottom_left,
+                              &bottom_right}) {
+      if (*child)
+        (*child)->template aggregate_in_radius_helper<F>(center, radius,
+                                                        result);
+    }
+  }
+
 public:
   Quadtree() = default;
 
@@ -170,6 +304,9 @@ public:
     const sf::Vector2f pos = get_position(*item);
     while (!is_in_bounds(pos))
       expand_towards(pos);
+    // Every node on the item's way down counts it.
+    if constexpr (has_field)
+      this->subtree.add(Field{}(*item));
 
     if (held) {
       add_to_child(std::move(item));
@@ -185,6 +322,80 @@ public:
     find_in_radius_helper(center, radius, result);
     return result;
   }
+
+  // Items with rect_left <= x <= rect_right and rect_top <= y <= rect_bottom.
+  // Nodes wholly inside the box are taken without testing their items.
+  std::vector<T *> find_in_rect(float rect_left, float rect_right,
+                                float rect_top, float rect_bottom) {
+    std::vector<T *> result;
+    find_in_rect_helper(rect_left, rect_right, rect_top, rect_bottom, result);
+    return result;
+  }
+
+  // The k items closest to center, nearest first (fewer if the tree is
+  // smaller). Best-first search: one queue holds nodes keyed by the distance
+  // to their bounds and items keyed by their own distance, so an item comes
+  // off the queue only once nothing left can be closer, and nodes farther
+  // than the k-th item are never opened.
+  std::vector<T *> find_k_nearest(sf::Vector2f center, size_t k) {
+    struct Entry {
+      float distance_sq;
+      Quadtree *node; // null for an item
+      T *item;
+      bool operator>(const Entry &other) const {
+        return distance_sq > other.distance_sq;
+      }
+    };
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+    std::vector<T *> result;
+    if (k == 0)
+      return result;
+
+    queue.push({distance_sq_to(center), this, nullptr});
+    while (!queue.empty()) {
+      Entry entry = queue.top();
+      queue.pop();
+      if (!entry.node) {
+        result.push_back(entry.item);
+        if (result.size() == k)
+          break;
+        continue;
+      }
+      Quadtree &node = *entry.node;
+      if (node.held)
+        queue.push({(get_position(*node.held) - center).lengthSquared(),
+                    nullptr, node.held.get()});
+      for (auto *child : {&node.top_left, &node.top_right, &node.bottom_left,
+                          &node.bottom_right}) {
+        if (*child)
+          queue.push({(*child)->distance_sq_to(center), child->get(), nullptr});
+      }
+    }
+    return result;
+  }
+
+  // Count, sum, min and max of Field over the items find_in_radius would
+  // return, without collecting them. Only for trees with a Field.
+  template <class F = Field>
+  QuadtreeAggregate aggregate_in_radius(sf::Vector2f center,
+                                        float radius) const {
+    static_assert(!std::is_void_v<F>, "aggregate_in_radius needs a Field");
+    QuadtreeAggregate result;
+    aggregate_in_radius_helper<F>(center, radius, result);
+    return result;
+  }
+
+  // Aggregate of every item in the tree.
+  template <class F = Field> QuadtreeAggregate aggregate() const {
+    static_assert(!std::is_void_v<F>, "aggregate needs a Field");
+    return this->subtree;
+  }
+
+  QuadtreeStats stats() const {
+    QuadtreeStats stats;
+    stats_helper(stats, 0);
+    return stats;
+  }
 };
 
 extern template class Quadtree<sf::Vector2f>;
@@ -0,0 +1,4 @@
+#include "structures/quadtree_index.hh"
+
+template class QuadtreeIndex<sf::Vector2f>;
+template class QuadtreeIndex<House>;
@@ -0,0 +1,209 @@
+#pragma once
+
+#include "lib.hh"
+#include "structures/quadtree.hh"
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// A quadtree over an existing std::vector<T> that refers to items by RowId
+// instead of owning copies of them. The constructor computes the bounds of
+// every position up front and builds the whole tree in one top-down pass:
+// each node partitions its rows into the four quadrants in place, so every
+// node's rows are one contiguous run, and the quadrants of the upper levels
+// are built on separate threads.
+//
+// Nodes split until they hold at most leaf_size rows (or reach max_depth, so
+// many items at one position cannot deepen the tree forever). Positions are
+// copied next to the rows, so searches never touch the items they skip.
+//
+// The index is static. The vector must outlive it and keep the indexed
+// items' positions; items appended later are not indexed.
+template <class T> class QuadtreeIndex {
+  struct Entry {
+    sf::Vector2f position;
+    RowId row;
+  };
+
+  struct Node {
+    // Edges included; rows on a split line go to the right or bottom child.
+    float left, right, top, bottom;
+    size_t begin, end;
+    // Top left, top right, bottom left, bottom right; null for a leaf.
+    std::unique_ptr<Node[]> children;
+  };
+
+  const std::vector<T> *items;
+  std::vector<Entry> entries;
+  Node root{};
+  size_t leaf_size;
+
+  // Below this many rows a quadrant isn't worth a thread.
+  static constexpr size_t min_parallel_rows = 1 << 16;
+
+  void build_node(Node &node, size_t depth, unsigned int threads) {
+    if (node.end - node.begin <= leaf_size || depth >= max_depth)
+      return;
+
+    float mid_x = (node.left + node.right) / 2.0f;
+    float mid_y = (node.top + node.bottom) / 2.0f;
+    auto first = entries.begin() + node.begin;
+    auto last = entries.begin() + node.end;
+    auto middle = std::partition(
+        first, last, [&](const Entry &e) { return e.position.y < mid_y; });
+    auto is_left = [&](const Entry &e) { return e.position.x < mid_x; };
+    std::array<size_t, 5> cuts = {
+        node.begin,
+        static_cast<size_t>(std::partition(first, middle, is_left) -
+                            entries.begin()),
+        static_cast<size_t>(middle - entries.begin()),
+        static_cast<size_t>(std::partition(middle, last, is_left) -
+                            entries.begin()),
+        node.end};
+
+    node.children = std::make_unique<Node[]>(4);
+    for (size_t i = 0; i < 4; i++) {
+      Node &child = node.children[i];
+      child.left = i & 1 ? mid_x : node.left;
+      child.right = i & 1 ? node.right : mid_x;
+      child.top = i & 2 ? mid_y : node.top;
+      child.bottom = i & 2 ? node.bottom : mid_y;
+      child.begin = cuts[i];
+      child.end = cuts[i + 1];
+    }
+
+    // The quadrants' rows are disjoint, so they can be built concurrently.
+    if (threads > 1 && node.end - node.begin >= min_parallel_rows) {
+      unsigned int share = std::max(1u, threads / 4);
+      std::vector<std::thread> workers;
+      for (size_t i = 1; i < 4; i++) {
+        workers.emplace_back([this, &node, i, depth, share] {
+          build_node(node.children[i], depth + 1, share);
+        });
+      }
+      build_node(node.children[0], depth + 1, share);
+      for (std::thread &worker : workers)
+        worker.join();
+    } else {
+      for (size_t i = 0; i < 4; i++)
+        build_node(node.children[i], depth + 1, 1);
+    }
+  }
+
+  // Calls visit(row) for every row within radius of center.
+  template <typename Visit>
+  void search(const Node &node, sf::Vector2f center, float radius,
+              Visit &visit) const {
+    if (node.begin == node.end)
+      return;
+    float dx = std::max(0.0f, std::max(center.x - node.right,
+                                       node.left - center.x));
+    float dy = std::max(0.0f, std::max(center.y - node.bottom,
+                                       node.top - center.y));
+    if (dx * dx + dy * dy > radius * radius)
+      return;
+
+    float fx = std::max(center.x - node.left, node.right - center.x);
+    float fy = std::max(center.y - node.top, node.bottom - center.y);
+    if (fx * fx + fy * fy <= radius * radius) {
+      for (size_t i = node.begin; i < node.end; i++)
+        visit(entries[i].row);
+    } else if (!node.children) {
+      for (size_t i = node.begin; i < node.end; i++) {
+        if ((entries[i].position - center).lengthSquared() <= radius * radius)
+          visit(entries[i].row);
+      }
+    } else {
+      for (size_t i = 0; i < 4; i++)
+        search(node.children[i], center, radius, visit);
+    }
+  }
+
+  static void stats_helper(const Node &node, QuadtreeStats &stats,
+                           size_t depth) {
+    stats.nodes++;
+    stats.max_depth = std::max(stats.max_depth, depth);
+    stats.bytes += sizeof(Node);
+    if (node.children) {
+      for (size_t i = 0; i < 4; i++)
+        stats_helper(node.children[i], stats, depth + 1);
+    }
+  }
+
+public:
+  static constexpr size_t max_depth = 32;
+
+  // Indexes every item of items. threads = 0 uses one per hardware thread;
+  // the tree is the same for any thread count. Throws std::length_error if
+  // items holds more than RowId can address.
+  explicit QuadtreeIndex(const std::vector<T> &items, size_t leaf_size = 16,
+                         unsigned int threads = 0)
+      : items(&items), leaf_size(leaf_size) {
+    if (leaf_size == 0)
+      throw std::invalid_argument("QuadtreeIndex: leaf_size must be > 0");
+    if (items.size() > static_cast<size_t>(static_cast<RowId>(-1)) + 1)
+      throw std::length_error("QuadtreeIndex: too many items");
+    if (threads == 0)
+      threads = std::max(1u, std::thread::hardware_concurrency());
+
+    entries.resize(items.size());
+    for (size_t i = 0; i < items.size(); i++)
+      entries[i] = {get_position(items[i]), static_cast<RowId>(i)};
+    if (entries.empty())
+      return;
+
+    // A square root around every position, so cells stay square.
+    sf::Vector2f low = entries[0].position, high = low;
+    for (const Entry &e : entries) {
+      low = {std::min(low.x, e.position.x), std::min(low.y, e.position.y)};
+      high = {std::max(high.x, e.position.x), std::max(high.y, e.position.y)};
+    }
+    // low + (high - low) can round below high, which would leave the
+    // farthest positions outside the root; the bounds are closed, so
+    // reaching high is enough.
+    float side = std::max(high.x - low.x, high.y - low.y);
+    root.left = low.x;
+    root.right = std::max(low.x + side, high.x);
+    root.top = low.y;
+    root.bottom = std::max(low.y + side, high.y);
+    root.begin = 0;
+    root.end = entries.size();
+    build_node(root, 0, threads);
+  }
+
+  std::vector<const T *> find_in_radius(sf::Vector2f center,
+                                        float radius) const {
+    std::vector<const T *> result;
+    auto visit = [&](RowId row) { result.push_back(&(*items)[row]); };
+    search(root, center, radius, visit);
+    return result;
+  }
+
+  // The same search, as rows of the indexed vector.
+  std::vector<RowId> find_rows_in_radius(sf::Vector2f center,
+                                         float radius) const {
+    std::vector<RowId> result;
+    auto visit = [&](RowId row) { result.push_back(row); };
+    search(root, center, radius, visit);
+    return result;
+  }
+
+  size_t size() const { return entries.size(); }
+  size_t get_leaf_size() const { return leaf_size; }
+
+  // bytes counts the index itself, not the items it refers to.
+  QuadtreeStats stats() const {
+    QuadtreeStats stats;
+    stats_helper(root, stats, 0);
+    stats.items = entries.size();
+    stats.bytes += entries.capacity() * sizeof(Entry);
+    return stats;
+  }
+};
+
+extern template class QuadtreeIndex<sf::Vector2f>;
+extern template class QuadtreeIndex<House>;
@@ -1,161 +1,305 @@
 #include "redblack.hh"
 #include "lib.hh"
+#include <stdexcept>
 
-RBTree* RedBlackTree::insert_node(RBTree *root, RBTree *newnode){
-    if (root == nullptr){
-        return newnode;
+NodeIndex RedBlackTree::new_node(float price, RowId row){
+    if (count == nil){
+        throw std::length_error("RedBlackTree: too many nodes for a 31-bit index");
     }
-    if (newnode->house.price < root->house.price){
-        root->left = insert_node(root->left, newnode);
-        root->left->parent = root;
+    if ((count & (block_size - 1)) == 0){
+        blocks.emplace_back(new RBTree[block_size]);
     }
-    else{
-        root->right = insert_node(root->right, newnode);
-        root->right->parent = root;
-    }
-    return root;
+    NodeIndex i = count++;
+    RBTree& n = node(i);
+    n.price = price;
+    n.row = row;
+    n.left = nil;
+    n.right = nil;
+    n.parent_color = nil;
+    n.size = 1;
+    return i;
 }
 
-void RedBlackTree::left_rotate(RBTree*& root, RBTree* x){
-    RBTree* y = x->right;
-    x->right = y->left;
-    if (y->left != nullptr)
-        y->left->parent = x;
+void RedBlackTree::left_rotate(NodeIndex x){
+    NodeIndex y = node(x).right;
+    node(x).right = node(y).left;
+    if (node(y).left != nil)
+        node(node(y).left).set_parent(x);
 
-    y->parent = x->parent;
-    if (x->parent == nullptr) {
+    NodeIndex xp = node(x).parent();
+    node(y).set_parent(xp);
+    if (xp == nil) {
         root = y;
     }
-    else if (x == x->parent->left){
-        x->parent->left = y;
+    else if (x == node(xp).left){
+        node(xp).left = y;
     }
     else{
-        x->parent->right = y;
+        node(xp).right = y;
     }
-    y->left = x;
-    x->parent = y;
+    node(y).left = x;
+    node(x).set_parent(y);
+    //y takes over x's subtree; x keeps what is left of its own
+    node(y).size = node(x).size;
+    node(x).size = subtree_size(node(x).left) + subtree_size(node(x).right) + 1;
 }
 
-void RedBlackTree::right_rotate(RBTree*& root, RBTree* x){
-    RBTree* y = x->left;
-    x->left = y->right;
-    if (y->right != nullptr){
-        y->right->parent = x;
+void RedBlackTree::right_rotate(NodeIndex x){
+    NodeIndex y = node(x).left;
+    node(x).left = node(y).right;
+    if (node(y).right != nil){
+        node(node(y).right).set_parent(x);
     }
-    y->parent = x->parent;
-    if (x->parent == nullptr){
+    NodeIndex xp = node(x).parent();
+    node(y).set_parent(xp);
+    if (xp == nil){
         root = y;
     }
-    else if (x == x->parent->right){
-        x->parent->right = y;
+    else if (x == node(xp).right){
+        node(xp).right = y;
     }
     else{
-        x->parent->left = y;
+        node(xp).left = y;
     }
-    y->right = x;
-    x->parent = y;
+    node(y).right = x;
+    node(x).set_parent(y);
+    node(y).size = node(x).size;
+    node(x).size = subtree_size(node(x).left) + subtree_size(node(x).right) + 1;
 }
 
-void RedBlackTree::balance(RBTree*& root, RBTree*& node){
-    while (node != root && node->parent->color_node == Red){
-        RBTree* grandparent = node->parent->parent;
+void RedBlackTree::balance(NodeIndex n){
+    while (n != root && node(node(n).parent()).color() == Red){
+        NodeIndex parent = node(n).parent();
+        NodeIndex grandparent = node(parent).parent();
 
-        if (node->parent == grandparent->left){
-            RBTree* uncle = grandparent->right;
+        if (parent == node(grandparent).left){
+            NodeIndex uncle = node(grandparent).right;
 
-            if (uncle && uncle->color_node == Red){
-                node->parent->color_node = Black;
-                uncle->color_node = Black;
-                grandparent->color_node = Red;
-                node = grandparent;
+            if (uncle != nil && node(uncle).color() == Red){
+                node(parent).set_color(Black);
+                node(uncle).set_color(Black);
+                node(grandparent).set_color(Red);
+                n = grandparent;
             }
             else{
-                if (node == node->parent->right){
-                    node = node->parent;
-                    left_rotate(root, node);
+                if (n == node(parent).right){
+                    n = parent;
+                    left_rotate(n);
                 }
-                node->parent->color_node = Black;
-                grandparent->color_node = Red;
-                right_rotate(root, grandparent);
+                node(node(n).parent()).set_color(Black);
+                node(grandparent).set_color(Red);
+                right_rotate(grandparent);
             }
         }
         else{
-            RBTree* uncle = grandparent->left;
-            if (uncle && uncle->color_node == Red){
-                node->parent->color_node = Black;
-                uncle->color_node = Black;
-                grandparent->color_node = Red;
-                node = grandparent;
+            NodeIndex uncle = node(grandparent).left;
+            if (uncle != nil && node(uncle).color() == Red){
+                node(parent).set_color(Black);
+                node(uncle).set_color(Black);
+                node(grandparent).set_color(Red);
+                n = grandparent;
             }
             else{
-                if (node == node->parent->left){
-                    node = node->parent;
-                    right_rotate(root, node);
+                if (n == node(parent).left){
+                    n = parent;
+                    right_rotate(n);
                 }
-                node->parent->color_node = Black;
-                grandparent->color_node = Red;
-                left_rotate(root, grandparent);
+                node(node(n).parent()).set_color(Black);
+                node(grandparent).set_color(Red);
+                left_rotate(grandparent);
             }
         }
     }
-    root->color_node = Black;
+    node(root).set_color(Black);
 }
 
-void RedBlackTree::insert(House house){         //combines functionality of insert functions above
-    RBTree* newNode = new RBTree(house);
-    root = insert_node(root, newNode);
-    balance(root, newNode);
+void RedBlackTree::insert(float price, RowId row){
+    NodeIndex added = new_node(price, row);
+
+    //walk down to the empty spot, equal prices going right, counting the new
+    //node into every subtree on the way
+    NodeIndex parent = nil;
+    NodeIndex current = root;
+    while (current != nil){
+        parent = current;
+        ++node(current).size;
+        current = price < node(current).price ? node(current).left : node(current).right;
+    }
+    node(added).set_parent(parent);
+    if (parent == nil){
+        root = added;
+    }
+    else if (price < node(parent).price){
+        node(parent).left = added;
+    }
+    else{
+        node(parent).right = added;
+    }
+    balance(added);
+}
+
+void RedBlackTree::build_from_sorted(const std::vector<std::pair<float, RowId>>& sorted){
+    clear();
+    if (sorted.empty()){
+        return;
+    }
+    //splitting at the middle puts every empty child at depth d or d + 1, where
+    //d = floor(log2(n + 1)). coloring the nodes at depth d red gives every path
+    //exactly d black nodes, and those red nodes are leaves with black parents.
+    size_t red_depth = 0;
+    while ((size_t{2} << red_depth) <= sorted.size() + 1){
+        ++red_depth;
+    }
+    blocks.reserve((sorted.size() + block_size - 1) / block_size);
+    root = build_balanced(sorted, 0, sorted.size(), 0, red_depth);
+    node(root).set_color(Black);
 }
 
-RBTree* RedBlackTree::search(RBTree* node, float price){
-    if (node == nullptr || node->house.price == price){
-        return node;
+//recursion depth is the tree height, about log2(n)
+NodeIndex RedBlackTree::build_balanced(const std::vector<std::pair<float, RowId>>& sorted, size_t first, size_t last, size_t depth, size_t red_depth){
+    if (first >= last){
+        return nil;
+    }
+    size_t mid = first + (last - first) / 2;
+    NodeIndex n = new_node(sorted[mid].first, sorted[mid].second);
+    node(n).set_color(depth == red_depth ? Red : Black);
+
+    NodeIndex left = build_balanced(sorted, first, mid, depth + 1, red_depth);
+    NodeIndex right = build_balanced(sorted, mid + 1, last, depth + 1, red_depth);
+    node(n).left = left;
+    node(n).right = right;
+    node(n).size = static_cast<NodeIndex>(last - first);
+    if (left != nil){
+        node(left).set_parent(n);
     }
-    if (price < node->house.price){
-        return search(node->left, price);
+    if (right != nil){
+        node(right).set_parent(n);
     }
-    return search(node->right, price);
+    return n;
 }
 
-std::vector<House*> RedBlackTree::price_range(float min, float max){
-    std::vector<House*> result;
-    price_range_helper(root, min, max, result);
+RowId* RedBlackTree::search(float price){
+    NodeIndex current = root;
+    while (current != nil){
+        RBTree& n = node(current);
+        if (n.price == price){
+            return &n.row;
+        }
+        current = price < n.price ? n.left : n.right;
+    }
+    return nullptr;
+}
+
+std::vector<RowId*> RedBlackTree::price_range(float min, float max){
+    std::vector<RowId*> result;
+    RangeCursor cursor = range(min, max);
+    while (RowId* row = cursor.next()){
+        result.push_back(row);
+    }
     return result;
 }
 
-void RedBlackTree::price_range_helper(RBTree* node, float min, float max, std::vector<House*>& result){
-    if (!node){
-        return;
+RedBlackTree::RangeCursor RedBlackTree::range(float min, float max){
+    RangeCursor cursor;
+    cursor.tree = this;
+    cursor.current = root;
+    cursor.min = min;
+    cursor.max = max;
+    return cursor;
+}
+
+//in-order walk that skips subtrees below min. the walk is sorted by price,
+//so it stops at the first price above max. rotations can leave equal prices
+//on either side, so equal keys go left too
+RowId* RedBlackTree::RangeCursor::next(){
+    while (current != nil){
+        const RBTree& n = tree->node(current);
+        if (min <= n.price){
+            stack.push_back(current);
+            current = n.left;
+        }
+        else{
+            current = n.right;
+        }
     }
-    if (min < node->house.price){
-        price_range_helper(node->left, min, max, result);
+    if (stack.empty()){
+        return nullptr;
     }
-    if (min <= node->house.price && node->house.price <= max){
-        result.push_back(&node->house);
+    RBTree& n = tree->node(stack.back());
+    stack.pop_back();
+    if (n.price > max){
+        stack.clear();
+        return nullptr;
     }
-    if (max > node->house.price){
-        price_range_helper(node->right, min, max, result);
+    current = n.right;
+    return &n.row;
+}
+
+size_t RedBlackTree::rank(float price, bool inclusive) const{
+    //the in-order walk is sorted by price, so whole left subtrees can be
+    //counted at once
+    size_t below = 0;
+    NodeIndex current = root;
+    while (current != nil){
+        const RBTree& n = node(current);
+        if (n.price < price || (inclusive && n.price == price)){
+            below += subtree_size(n.left) + 1;
+            current = n.right;
+        }
+        else{
+            current = n.left;
+        }
     }
+    return below;
 }
 
-void RedBlackTree::inorder_traversal(RBTree* node, std::map<float, Color>& result){
-    if (node == nullptr){
-        return;
+size_t RedBlackTree::count_in_range(float min, float max) const{
+    if (max < min){
+        return 0;
     }
-    inorder_traversal(node->left, result);
-    result[node->house.price] = node->color_node;
-    inorder_traversal(node->right, result);
+    return rank(max, true) - rank(min, false);
 }
 
-RedBlackTree::~RedBlackTree(){
-    delete_tree(root);
+RowId* RedBlackTree::select_in_range(float min, float max, size_t k){
+    if (k >= count_in_range(min, max)){
+        return nullptr;
+    }
+    //find the node at in-order position rank(min) + k
+    size_t wanted = rank(min, false) + k;
+    NodeIndex current = root;
+    while (true){
+        RBTree& n = node(current);
+        size_t left = subtree_size(n.left);
+        if (wanted < left){
+            current = n.left;
+        }
+        else if (wanted == left){
+            return &n.row;
+        }
+        else{
+            wanted -= left + 1;
+            current = n.right;
+        }
+    }
 }
 
-void RedBlackTree::delete_tree(RBTree* node){
-    if (!node){
-        return;
+void RedBlackTree::inorder_traversal(NodeIndex start, std::map<float, Color>& result) const{
+    std::vector<NodeIndex> stack;
+    NodeIndex current = start;
+    while (current != nil || !stack.empty()){
+        while (current != nil){
+            stack.push_back(current);
+            current = node(current).left;
+        }
+        const RBTree& n = node(stack.back());
+        stack.pop_back();
+        result[n.price] = n.color();
+        current = n.right;
     }
-    delete_tree(node->left);
-    delete_tree(node->right);
-    delete node;
-}
\ No newline at end of file
+}
+
+void RedBlackTree::clear(){
+    blocks.clear();
+    count = 0;
+    root = nil;
+}
@@ -1,44 +1,121 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <memory>
+#include <utility>
 #include <vector>
 #include "../lib.hh"
 
 enum Color{Red, Black};
 //https://stackoverflow.com/questions/27080879/implementing-enumeration-types-in-c
+
+//index of a node in a RedBlackTree's arena
+using NodeIndex = std::uint32_t;
+
+//a node lives in its tree's arena and links to others by 32-bit index. the
+//parent index takes the low 31 bits of parent_color and the color the top bit.
+//it holds the house's row in the caller's dataset, not the house, with the
+//price cached next to it so walks never leave the arena: 24 bytes a node
 struct RBTree{
-    House house;
+    static constexpr NodeIndex nil = 0x7fffffff;
+    static constexpr std::uint32_t black_bit = 0x80000000;
 
-    Color color_node;
-    RBTree* left;
-    RBTree* right;
-    RBTree* parent;
-    RBTree(House house): house(house), color_node(Red), left (nullptr), right(nullptr), parent(nullptr){}
+    float price = 0;
+    RowId row = 0;
+    NodeIndex left = nil;
+    NodeIndex right = nil;
+    std::uint32_t parent_color = nil;   //red, no parent
+    NodeIndex size = 1;                 //nodes in this subtree, itself included
+
+    NodeIndex parent() const {return parent_color & ~black_bit;}
+    Color color() const {return (parent_color & black_bit) ? Black : Red;}
+    void set_parent(NodeIndex p){parent_color = (parent_color & black_bit) | p;}
+    void set_color(Color c){parent_color = (parent_color & ~black_bit) | (c == Black ? black_bit : 0);}
 };
 
+//maps prices to row ids, like BPlusTree<float, RowId>
 class RedBlackTree{
 private:
-    RBTree* insert_node(RBTree *root, RBTree *newnode);
+    //nodes are handed out from fixed-size blocks, so they never move and the
+    //row pointers price_range returns stay valid while the tree grows
+    static constexpr unsigned block_bits = 12;
+    static constexpr NodeIndex block_size = NodeIndex{1} << block_bits;
+    std::vector<std::unique_ptr<RBTree[]>> blocks;
+    NodeIndex count = 0;
+
+    NodeIndex new_node(float price, RowId row);
+
+    void left_rotate(NodeIndex x);
+
+    void right_rotate(NodeIndex y);
+
+    void balance(NodeIndex node);
 
-    void left_rotate(RBTree*& root, RBTree* x);
+    NodeIndex subtree_size(NodeIndex i) const{return i == nil ? 0 : node(i).size;}
 
-    void right_rotate(RBTree*& root, RBTree* y);
+    //nodes priced below price (or at or below it, when inclusive)
+    size_t rank(float price, bool inclusive) const;
 
-    void balance(RBTree*& root, RBTree*& node);
+    NodeIndex build_balanced(const std::vector<std::pair<float, RowId>>& sorted, size_t first, size_t last, size_t depth, size_t red_depth);
 
 public:
-    RBTree* root = nullptr;
-    void insert(House house);
+    static constexpr NodeIndex nil = RBTree::nil;
+
+    NodeIndex root = nil;
+
+    RBTree& node(NodeIndex i){return blocks[i >> block_bits][i & (block_size - 1)];}
+    const RBTree& node(NodeIndex i) const{return blocks[i >> block_bits][i & (block_size - 1)];}
+    size_t size() const{return count;}
+
+    void insert(float price, RowId row);
+
+    //replaces the tree with one built from (price, row) pairs sorted by
+    //price, in O(n) with no rotations
+    void build_from_sorted(const std::vector<std::pair<float, RowId>>& sorted);
+
+    //the row of a house with this price, or nullptr
+    RowId* search(float price);
+
+    std::vector<RowId*> price_range(float min, float max);
+
+    //the same range as the matching rows of `rows` (e.g. a std::vector<House>)
+    template <typename Rows>
+    std::vector<typename Rows::value_type*> price_range(float min, float max, Rows& rows){
+        std::vector<typename Rows::value_type*> result;
+        RangeCursor cursor = range(min, max);
+        while (RowId* row = cursor.next()){
+            result.push_back(&rows[*row]);
+        }
+        return result;
+    }
 
-    RBTree* search(RBTree* node, float price);
+    //walks the rows of price_range(min, max) one at a time, in the same
+    //order, with an explicit stack. valid until the tree is modified
+    class RangeCursor{
+    public:
+        //the next row, or nullptr once the range is exhausted
+        RowId* next();
 
-    std::vector<House*> price_range(float min, float max);
+    private:
+        friend class RedBlackTree;
+        RedBlackTree* tree = nullptr;
+        std::vector<NodeIndex> stack;
+        NodeIndex current = nil;
+        float min = 0;
+        float max = 0;
+    };
+    RangeCursor range(float min, float max);
 
-    void price_range_helper(RBTree* node, float min, float max, std::vector<House*>& result);
+    //how many rows price_range(min, max) would return, in O(log n)
+    size_t count_in_range(float min, float max) const;
 
-    void inorder_traversal(RBTree* node, std::map<float, Color>& result);
+    //price_range(min, max)[k] without building the range, in O(log n), or
+    //nullptr when k is past the end
+    RowId* select_in_range(float min, float max, size_t k);
 
-    ~RedBlackTree();
+    void inorder_traversal(NodeIndex node, std::map<float, Color>& result) const;
 
-    void delete_tree(RBTree* node);
+    //frees every node at once
+    void clear();
 };
@@ -0,0 +1,5 @@
+#include "versioned_bplustree.hh"
+
+template class VersionedBPlusTree<float, RowId, 3>;
+template class VersionedBPlusTree<float, RowId, 21>;
+template class VersionedBPlusTree<int, int, 4>;
@@ -0,0 +1,349 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "lib.hh"
+#include "structures/node_search.hh"
+
+// A B+ tree that one writer updates while any number of threads read
+// consistent versions of it, without locks on the read side.
+//
+// Nodes are never changed once a version holding them is published. The
+// writer copies every node on the path it changes (path copying), and
+// publish() makes the new root visible with an atomic store. A Snapshot keeps
+// its version's nodes alive through shared_ptr reference counts, so an old
+// version is freed when its last reader lets go.
+//
+// Between two publish() calls the writer edits the copies it already made in
+// place, so a batch of inserts copies each node it touches once rather than
+// once per insert.
+//
+// Internal nodes also keep the number of entries below each child, so
+// counting a range and jumping to its k-th match take O(log n). There is no
+// leaf chain (a chain would make every insert copy the whole tree to its
+// left); range walks keep a path stack instead.
+//
+// Leaves hold up to Order keys and duplicates are allowed, as in BPlusTree.
+template <typename K, typename V, size_t Order>
+class VersionedBPlusTree {
+    static_assert(Order >= 3, "VersionedBPlusTree needs an order of at least 3");
+
+    struct Node {
+        std::uint64_t epoch;  // the writer batch that created the node
+        bool isLeaf;
+        std::uint32_t count = 0;  // keys in use
+        std::array<K, Order + 1> keys{};
+        Node(std::uint64_t epoch, bool isLeaf) : epoch(epoch), isLeaf(isLeaf) {}
+    };
+    struct LeafNode : Node {
+        std::array<V, Order + 1> values{};
+        explicit LeafNode(std::uint64_t epoch) : Node(epoch, true) {}
+    };
+    struct InternalNode : Node {
+        // count + 1 children, and how many entries each one holds.
+        std::array<std::shared_ptr<Node>, Order + 1> children;
+        std::array<size_t, Order + 1> sizes{};
+        explicit InternalNode(std::uint64_t epoch) : Node(epoch, false) {}
+    };
+
+public:
+    // One published version. Cheap to copy, safe to use from any thread, and
+    // unaffected by later writes.
+    class Snapshot {
+    public:
+        size_t size() const { return entries; }
+        // Entries with key < key, or key <= key when inclusive.
+        size_t rank(const K& key, bool inclusive) const;
+        size_t countRange(const K& low, const K& high) const {
+            return high < low ? 0 : rank(high, true) - rank(low, false);
+        }
+        // Values with low <= key <= high, in key order, as BPlusTree::getRange
+        // returns them. The pointers live as long as the snapshot.
+        std::vector<const V*> getRange(const K& low, const K& high) const;
+        // For trees whose values are row ids: the rows they point at.
+        template <typename Rows>
+        std::vector<typename Rows::value_type*> getRange(const K& low, const K& high, Rows& rows) const;
+
+        // Walks the matches one at a time, starting `skip` matches in. The
+        // cursor keeps its version alive, so it may outlive the snapshot.
+        class RangeCursor {
+        public:
+            // The next match, or nullptr once the range is exhausted.
+            const V* next();
+
+        private:
+            friend class Snapshot;
+            std::shared_ptr<const Node> root;
+            std::vector<std::pair<const InternalNode*, size_t>> path;
+            const LeafNode* leaf = nullptr;
+            size_t idx = 0;
+            size_t remaining = 0;
+        };
+        RangeCursor range(const K& low, const K& high, size_t skip = 0) const;
+
+    private:
+        friend class VersionedBPlusTree;
+        std::shared_ptr<const Node> root;
+        size_t entries = 0;
+    };
+
+    // The last published version.
+    Snapshot snapshot() const;
+
+    // Writer side. Only one thread may call these, and the changes stay
+    // invisible to snapshot() until publish().
+    void insert(K key, V value);
+    void publish();
+    size_t size() const { return working.entries; }
+
+private:
+    // The writer's version, and the one readers load. Readers only ever
+    // touch published through std::atomic_load.
+    Snapshot working;
+    std::shared_ptr<const Snapshot> published = std::make_shared<const Snapshot>();
+    std::uint64_t epoch = 1;
+
+    static size_t entriesIn(const Node* node);
+    // node itself if this batch created it, else a copy this batch owns.
+    std::shared_ptr<Node> own(const std::shared_ptr<Node>& node);
+};
+
+template <typename K, typename V, size_t Order>
+size_t VersionedBPlusTree<K, V, Order>::entriesIn(const Node* node) {
+    if (node->isLeaf)
+        return node->count;
+    auto in = static_cast<const InternalNode*>(node);
+    size_t total = 0;
+    for (size_t i = 0; i <= in->count; ++i)
+        total += in->sizes[i];
+    return total;
+}
+
+template <typename K, typename V, size_t Order>
+std::shared_ptr<typename VersionedBPlusTree<K, V, Order>::Node>
+VersionedBPlusTree<K, V, Order>::own(const std::shared_ptr<Node>& node) {
+    if (node->epoch == epoch)
+        return node;
+    std::shared_ptr<Node> copy;
+    if (node->isLeaf)
+        copy = std::make_shared<LeafNode>(*static_cast<const LeafNode*>(node.get()));
+    else
+        copy = std::make_shared<InternalNode>(*static_cast<const InternalNode*>(node.get()));
+    copy->epoch = epoch;
+    return copy;
+}
+
+template <typename K, typename V, size_t Order>
+void VersionedBPlusTree<K, V, Order>::insert(K key, V value) {
+    //The writer's root is only ever shared with published versions, never
+    //changed in place unless this batch made it.
+    auto root = std::const_pointer_cast<Node>(working.root);
+    if (!root)
+        root = std::make_shared<LeafNode>(epoch);
+    root = own(root);
+
+    //Descend as BPlusTree::findLeaf does, owning each node on the way and
+    //counting the new entry into every subtree it passes.
+    //Internal nodes keep at least two children, so 64 levels is more than a
+    //size_t of entries can fill.
+    std::array<std::pair<InternalNode*, size_t>, 64> path;
+    size_t depth = 0;
+    Node* node = root.get();
+    while (!node->isLeaf) {
+        auto in = static_cast<InternalNode*>(node);
+        size_t i = node_upper_bound(in->keys.data(), in->count, key);
+        in->children[i] = own(in->children[i]);
+        ++in->sizes[i];
+        path[depth++] = {in, i};
+        node = in->children[i].get();
+    }
+
+    auto leaf = static_cast<LeafNode*>(node);
+    size_t count = leaf->count;
+    size_t index = node_upper_bound(leaf->keys.data(), count, key);
+    std::move_backward(leaf->keys.begin() + index, leaf->keys.begin() + count,
+                       leaf->keys.begin() + count + 1);
+    std::move_backward(leaf->values.begin() + index, leaf->values.begin() + count,
+                       leaf->values.begin() + count + 1);
+    leaf->keys[index] = key;
+    leaf->values[index] = value;
+    leaf->count = static_cast<std::uint32_t>(++count);
+    ++working.entries;
+
+    std::shared_ptr<Node> right;
+    K separator{};
+    if (count > Order) {
+        auto sibling = std::make_shared<LeafNode>(epoch);
+        size_t mid = count / 2;
+        std::copy(leaf->keys.begin() + mid, leaf->keys.begin() + count, sibling->keys.begin());
+        std::copy(leaf->values.begin() + mid, leaf->values.begin() + count, sibling->values.begin());
+        sibling->count = static_cast<std::uint32_t>(count - mid);
+        leaf->count = static_cast<std::uint32_t>(mid);
+        separator = sibling->keys[0];
+        right = sibling;
+    }
+
+    //Push splits up the path, as FlatBPlusTree::insert does.
+    while (right && depth > 0) {
+        auto [parent, i] = path[--depth];
+        Node* left = parent->children[i].get();
+        count = parent->count;
+        std::move_backward(parent->keys.begin() + i, parent->keys.begin() + count,
+                           parent->keys.begin() + count + 1);
+        std::move_backward(parent->children.begin() + i + 1, parent->children.begin() + count + 1,
+                           parent->children.begin() + count + 2);
+        std::move_backward(parent->sizes.begin() + i + 1, parent->sizes.begin() + count + 1,
+                           parent->sizes.begin() + count + 2);
+        parent->keys[i] = separator;
+        parent->children[i + 1] = right;
+        parent->sizes[i] = entriesIn(left);
+        parent->sizes[i + 1] = entriesIn(right.get());
+        parent->count = static_cast<std::uint32_t>(++count);
+        right.reset();
+        if (count < Order)
+            break;
+
+        auto sibling = std::make_shared<InternalNode>(epoch);
+        size_t mid = count / 2;
+        separator = parent->keys[mid];
+        std::copy(parent->keys.begin() + mid + 1, parent->keys.begin() + count, sibling->keys.begin());
+        for (size_t c = mid + 1; c <= count; ++c) {
+            sibling->children[c - mid - 1] = std::move(parent->children[c]);
+            sibling->sizes[c - mid - 1] = parent->sizes[c];
+        }
+        sibling->count = static_cast<std::uint32_t>(count - mid - 1);
+        parent->count = static_cast<std::uint32_t>(mid);
+        right = sibling;
+    }
+
+    if (right) {
+        //The root split: grow the tree by one level.
+        auto newRoot = std::make_shared<InternalNode>(epoch);
+        newRoot->keys[0] = separator;
+        newRoot->sizes[0] = entriesIn(root.get());
+        newRoot->sizes[1] = entriesIn(right.get());
+        newRoot->children[0] = root;
+        newRoot->children[1] = right;
+        newRoot->count = 1;
+        root = newRoot;
+    }
+    working.root = root;
+}
+
+template <typename K, typename V, size_t Order>
+void VersionedBPlusTree<K, V, Order>::publish() {
+    std::atomic_store(&published, std::make_shared<const Snapshot>(working));
+    //Everything made so far is now shared; the next batch copies it.
+    ++epoch;
+}
+
+template <typename K, typename V, size_t Order>
+typename VersionedBPlusTree<K, V, Order>::Snapshot
+VersionedBPlusTree<K, V, Order>::snapshot() const {
+    return *std::atomic_load(&published);
+}
+
+template <typename K, typename V, size_t Order>
+size_t VersionedBPlusTree<K, V, Order>::Snapshot::rank(const K& key, bool inclusive) const {
+    //Descend as findFirstLeaf (or findLeaf, when inclusive) would, counting
+    //the whole children passed on the left.
+    auto bound = [&](const Node* node) {
+        return inclusive ? node_upper_bound(node->keys.data(), node->count, key)
+                         : node_lower_bound(node->keys.data(), node->count, key);
+    };
+    size_t below = 0;
+    const Node* node = root.get();
+    if (!node)
+        return 0;
+    while (!node->isLeaf) {
+        auto in = static_cast<const InternalNode*>(node);
+        size_t i = bound(node);
+        for (size_t c = 0; c < i; ++c)
+            below += in->sizes[c];
+        node = in->children[i].get();
+    }
+    return below + bound(node);
+}
+
+template <typename K, typename V, size_t Order>
+typename VersionedBPlusTree<K, V, Order>::Snapshot::RangeCursor
+VersionedBPlusTree<K, V, Order>::Snapshot::range(const K& low, const K& high, size_t skip) const {
+    RangeCursor cursor;
+    if (high < low)
+        return cursor;
+    size_t first = rank(low, false);
+    size_t last = rank(high, true);
+    if (last - first <= skip)
+        return cursor;
+    cursor.remaining = last - first - skip;
+    cursor.root = root;
+
+    //Walk down to the entry at position first + skip by the subtree sizes.
+    size_t position = first + skip;
+    const Node* node = root.get();
+    while (!node->isLeaf) {
+        auto in = static_cast<const InternalNode*>(node);
+        size_t c = 0;
+        while (position >= in->sizes[c])
+            position -= in->sizes[c++];
+        cursor.path.emplace_back(in, c);
+        node = in->children[c].get();
+    }
+    cursor.leaf = static_cast<const LeafNode*>(node);
+    cursor.idx = position;
+    return cursor;
+}
+
+template <typename K, typename V, size_t Order>
+const V* VersionedBPlusTree<K, V, Order>::Snapshot::RangeCursor::next() {
+    if (remaining == 0)
+        return nullptr;
+    if (idx == leaf->count) {
+        //Climb to the nearest ancestor with a child further right, then take
+        //the leftmost leaf below that child.
+        while (path.back().second == path.back().first->count)
+            path.pop_back();
+        auto& [in, c] = path.back();
+        const Node* node = in->children[++c].get();
+        while (!node->isLeaf) {
+            auto child = static_cast<const InternalNode*>(node);
+            path.emplace_back(child, 0);
+            node = child->children[0].get();
+        }
+        leaf = static_cast<const LeafNode*>(node);
+        idx = 0;
+    }
+    --remaining;
+    return &leaf->values[idx++];
+}
+
+template <typename K, typename V, size_t Order>
+std::vector<const V*> VersionedBPlusTree<K, V, Order>::Snapshot::getRange(const K& low, const K& high) const {
+    std::vector<const V*> out;
+    RangeCursor cursor = range(low, high);
+    out.reserve(cursor.remaining);
+    while (const V* value = cursor.next())
+        out.push_back(value);
+    return out;
+}
+
+template <typename K, typename V, size_t Order>
+template <typename Rows>
+std::vector<typename Rows::value_type*>
+VersionedBPlusTree<K, V, Order>::Snapshot::getRange(const K& low, const K& high, Rows& rows) const {
+    std::vector<typename Rows::value_type*> out;
+    RangeCursor cursor = range(low, high);
+    out.reserve(cursor.remaining);
+    while (const V* id = cursor.next())
+        out.push_back(&rows[*id]);
+    return out;
+}
+
+extern template class VersionedBPlusTree<float, RowId, 3>;
+extern template class VersionedBPlusTree<float, RowId, 21>;
+extern template class VersionedBPlusTree<int, int, 4>;
@@ -420,6 +420,16 @@ void Slider::setValue(float value) {
   updateValueTextPosition();
 }
 
+float Slider::getMin() const { return minValue; }
+
+float Slider::getMax() const { return maxValue; }
+
+void Slider::setRange(float min, float max) {
+  minValue = min;
+  maxValue = max;
+  setValue(currentValue);
+}
+
 void Slider::setShowValue(bool show) { showValue = show; }
 
 void Slider::setColors(sf::Color trackColor, sf::Color handleColor) {
@@ -210,6 +210,13 @@ public:
 
   void setValue(float value);
 
+  float getMin() const;
+
+  float getMax() const;
+
+  // Changes the selectable range, clamping the current value into it.
+  void setRange(float min, float max);
+
   void setShowValue(bool show);
 
   void setColors(sf::Color trackColor, sf::Color handleColor);
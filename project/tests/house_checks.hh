@@ -0,0 +1,10 @@
+#pragma once
+// Field-by-field House comparison shared by the loader and store tests.
+#include "../src/lib.hh"
+
+inline bool same_house(const House &a, const House &b) {
+  return a.address.to_string() == b.address.to_string() &&
+         a.position == b.position && a.price == b.price && a.area == b.area &&
+         a.room_count == b.room_count &&
+         a.bathroom_count == b.bathroom_count && a.features == b.features;
+}
@@ -0,0 +1,97 @@
+#pragma once
+// The sorted input and range checks shared by the B+ tree tests.
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Keys repeat three times each so runs of duplicates straddle leaves. Values
+// are 3 * key + n, so each value names its key.
+inline std::vector<std::pair<int, int>> make_sorted_pairs() {
+  std::vector<std::pair<int, int>> sorted;
+  for (int i = 0; i < 1000; ++i)
+    sorted.emplace_back(i / 3, i);
+  return sorted;
+}
+
+// Range results hold values or pointers to them, depending on the tree.
+inline int value_of(int value) { return value; }
+inline int value_of(const int *value) { return *value; }
+
+// getRange and countRange must answer like the sorted pairs: as many values
+// as keys in [low, high], with keys ascending. Values within a run of equal
+// keys may come in any order.
+template <typename Tree>
+bool check_ranges(Tree &tree, const std::vector<std::pair<int, int>> &sorted,
+                  const std::string &name) {
+  auto key_less = [](const std::pair<int, int> &kv, int key) {
+    return kv.first < key;
+  };
+  for (int low = -5; low < 360; low += 13) {
+    for (int width : {0, 1, 9, 100, 400}) {
+      int high = low + width;
+      size_t first =
+          std::lower_bound(sorted.begin(), sorted.end(), low, key_less) -
+          sorted.begin();
+      size_t expected = 0;
+      while (first + expected < sorted.size() &&
+             sorted[first + expected].first <= high)
+        ++expected;
+
+      auto got = tree.getRange(low, high);
+      if (got.size() != expected || tree.countRange(low, high) != expected) {
+        std::cerr << name << ": range(" << low << ", " << high << ") has "
+                  << got.size() << " values, expected " << expected << "\n";
+        return false;
+      }
+      for (size_t i = 0; i < got.size(); ++i) {
+        if (value_of(got[i]) / 3 != sorted[first + i].first) {
+          std::cerr << name << ": range(" << low << ", " << high << ")["
+                    << i << "] has the wrong key\n";
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+// search finds a value of every stored key and nothing else.
+template <typename Tree>
+bool check_search(Tree &tree, const std::vector<std::pair<int, int>> &sorted,
+                  const std::string &name) {
+  for (int key = -2; key < 340; ++key) {
+    auto found = tree.search(key);
+    bool stored = key >= 0 && key <= sorted.back().first;
+    if (static_cast<bool>(found) != stored || (found && *found / 3 != key)) {
+      std::cerr << name << ": search(" << key << ") is wrong\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// A range(low, high) cursor walks the getRange values, and skip agrees with
+// it.
+template <typename Tree> bool check_cursors(Tree &tree, const std::string &name) {
+  for (int low = -5; low < 360; low += 41) {
+    auto expected = tree.getRange(low, low + 50);
+    auto cursor = tree.range(low, low + 50);
+    for (auto *value : expected) {
+      if (cursor.next() != value) {
+        std::cerr << name << ": cursor differs from getRange\n";
+        return false;
+      }
+    }
+    auto skipping = tree.range(low, low + 50);
+    size_t skipped = skipping.skip(expected.size() / 2);
+    auto *after = skipping.next();
+    if (cursor.next() || skipped != expected.size() / 2 ||
+        after != (skipped < expected.size() ? expected[skipped] : nullptr)) {
+      std::cerr << name << ": cursor skip is wrong at " << low << "\n";
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,103 @@
+#pragma once
+// Point fixtures and brute-force checks shared by the quadtree tests.
+#include "../src/lib.hh"
+#include "../src/structures/quadtree.hh"
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <initializer_list>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Uniform points, a tight cluster and many copies of one point: the shapes
+// that push a quadtree to its depth limit. low..high may reach past a tree's
+// starting bounds so its root has to grow.
+struct PointMix {
+  unsigned int seed;
+  float low, high;
+  int uniform_count;
+  sf::Vector2f cluster_center;
+  float cluster_spread;
+  int cluster_count;
+  sf::Vector2f repeated;
+  int repeat_count;
+};
+
+inline std::vector<sf::Vector2f> make_points(const PointMix &mix) {
+  std::mt19937 rng(mix.seed);
+  std::uniform_real_distribution<float> uniform(mix.low, mix.high);
+  std::normal_distribution<float> cluster(0.0f, mix.cluster_spread);
+  std::vector<sf::Vector2f> points;
+  for (int i = 0; i < mix.uniform_count; i++)
+    points.push_back({uniform(rng), uniform(rng)});
+  for (int i = 0; i < mix.cluster_count; i++)
+    points.push_back({mix.cluster_center.x + cluster(rng),
+                      mix.cluster_center.y + cluster(rng)});
+  for (int i = 0; i < mix.repeat_count; i++)
+    points.push_back(mix.repeated);
+  return points;
+}
+
+// The cluster, the repeated point and `count` uniform centers.
+inline std::vector<sf::Vector2f> make_centers(const PointMix &mix, int count) {
+  std::mt19937 rng(mix.seed + 1);
+  std::uniform_real_distribution<float> uniform(mix.low, mix.high);
+  std::vector<sf::Vector2f> centers = {mix.cluster_center, mix.repeated};
+  for (int i = 0; i < count; i++)
+    centers.push_back({uniform(rng), uniform(rng)});
+  return centers;
+}
+
+inline bool less_point(sf::Vector2f a, sf::Vector2f b) {
+  return a.x < b.x || (a.x == b.x && a.y < b.y);
+}
+
+// The positions behind a search result, sorted so results compare equal
+// whatever order the tree visits them in.
+template <typename Found>
+std::vector<sf::Vector2f> sorted_positions(const Found &found) {
+  std::vector<sf::Vector2f> positions;
+  for (const auto *item : found)
+    positions.push_back(get_position(*item));
+  std::sort(positions.begin(), positions.end(), less_point);
+  return positions;
+}
+
+// Row ids of the points within radius of center, in row order.
+inline std::vector<RowId> rows_in_radius(const std::vector<sf::Vector2f> &points,
+                                         sf::Vector2f center, float radius) {
+  std::vector<RowId> rows;
+  for (std::size_t i = 0; i < points.size(); i++) {
+    if ((points[i] - center).lengthSquared() <= radius * radius)
+      rows.push_back(static_cast<RowId>(i));
+  }
+  return rows;
+}
+
+// Compares tree.find_in_radius with a scan of points for every center and
+// radius, reporting the first difference under name.
+template <typename Tree>
+bool check_radius_search(Tree &tree,
+                         const std::vector<sf::Vector2f> &points,
+                         const std::vector<sf::Vector2f> &centers,
+                         std::initializer_list<float> radii,
+                         const std::string &name) {
+  for (sf::Vector2f center : centers) {
+    for (float radius : radii) {
+      std::vector<sf::Vector2f> expected;
+      for (RowId row : rows_in_radius(points, center, radius))
+        expected.push_back(points[row]);
+      std::sort(expected.begin(), expected.end(), less_point);
+      std::vector<sf::Vector2f> got =
+          sorted_positions(tree.find_in_radius(center, radius));
+      if (got != expected) {
+        std::cerr << name << ": find_in_radius((" << center.x << ", "
+                  << center.y << "), " << radius << ") found " << got.size()
+                  << " points, expected " << expected.size() << "\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
@@ -0,0 +1,146 @@
+#include "../src/structures/versioned_bplustree.hh"
+#include "range_checks.hh"
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using Tree = VersionedBPlusTree<int, int, 4>;
+
+// A snapshot must answer exactly like the sorted pairs it was published with,
+// and its cursors must start at any skip.
+bool check_snapshot(const Tree::Snapshot &snapshot,
+                    std::vector<std::pair<int, int>> sorted,
+                    const std::string &name) {
+  std::sort(sorted.begin(), sorted.end());
+  if (snapshot.size() != sorted.size()) {
+    std::cerr << name << ": holds " << snapshot.size() << " values, expected "
+              << sorted.size() << "\n";
+    return false;
+  }
+  if (!check_ranges(snapshot, sorted, name))
+    return false;
+  for (int low = -5; low < 360; low += 13) {
+    for (int width : {0, 1, 9, 100, 400}) {
+      auto got = snapshot.getRange(low, low + width);
+      for (size_t skip : {size_t{0}, size_t{1}, got.size() / 2, got.size()}) {
+        auto cursor = snapshot.range(low, low + width, skip);
+        for (size_t i = skip; i < got.size(); ++i) {
+          if (cursor.next() != got[i]) {
+            std::cerr << name << ": cursor skipping " << skip
+                      << " differs from getRange\n";
+            return false;
+          }
+        }
+        if (cursor.next()) {
+          std::cerr << name << ": cursor ran past the range\n";
+          return false;
+        }
+      }
+    }
+  }
+  return true;
+}
+
+int main() {
+  try {
+    std::vector<std::pair<int, int>> pairs = make_sorted_pairs();
+    std::shuffle(pairs.begin(), pairs.end(), std::mt19937(11));
+
+    Tree tree;
+    if (tree.snapshot().size() != 0 || tree.snapshot().getRange(0, 400).size()) {
+      std::cerr << "A tree that never published should look empty\n";
+      return 1;
+    }
+
+    // Publish in uneven batches and keep every version: later writes must
+    // not show through older snapshots.
+    std::vector<Tree::Snapshot> versions;
+    std::vector<size_t> published_at;
+    size_t done = 0;
+    for (size_t batch : {1, 2, 7, 90, 400, 500}) {
+      for (size_t i = done; i < done + batch; ++i)
+        tree.insert(pairs[i].first, pairs[i].second);
+      done += batch;
+      if (tree.snapshot().size() != done - batch) {
+        std::cerr << "Inserts showed before publish\n";
+        return 1;
+      }
+      tree.publish();
+      versions.push_back(tree.snapshot());
+      published_at.push_back(done);
+    }
+    for (size_t v = 0; v < versions.size(); ++v) {
+      std::vector<std::pair<int, int>> prefix(pairs.begin(),
+                                              pairs.begin() + published_at[v]);
+      if (!check_snapshot(versions[v], prefix,
+                          "version " + std::to_string(v)))
+        return 1;
+    }
+
+    // One writer keeps publishing while readers check that each version they
+    // load is whole: its size is a multiple of the batch and every range
+    // count adds up.
+    const size_t batch = 64;
+    Tree shared;
+    std::atomic<bool> writing{true};
+    std::atomic<bool> failed{false};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < 3; ++r) {
+      readers.emplace_back([&] {
+        size_t last = 0;
+        while (writing && !failed) {
+          Tree::Snapshot snapshot = shared.snapshot();
+          size_t total = snapshot.countRange(0, 1 << 20);
+          size_t halves = snapshot.countRange(0, 5000) +
+                          snapshot.countRange(5001, 1 << 20);
+          if (snapshot.size() % batch != 0 || total != snapshot.size() ||
+              halves != total || snapshot.size() < last ||
+              snapshot.getRange(0, 1 << 20).size() != total)
+            failed = true;
+          last = snapshot.size();
+        }
+      });
+    }
+    std::mt19937 rng(12);
+    for (size_t i = 0; i < 200 * batch; ++i) {
+      int key = static_cast<int>(rng() % 10000);
+      shared.insert(key, key * 3);
+      if ((i + 1) % batch == 0)
+        shared.publish();
+    }
+    writing = false;
+    for (auto &reader : readers)
+      reader.join();
+    if (failed) {
+      std::cerr << "A reader saw a version that was not whole\n";
+      return 1;
+    }
+    if (shared.snapshot().size() != 200 * batch) {
+      std::cerr << "The last version is missing inserts\n";
+      return 1;
+    }
+
+    std::vector<std::string> rows = {"zero", "one", "two", "three"};
+    VersionedBPlusTree<float, RowId, 3> ids;
+    for (RowId id : {2, 0, 3, 1})
+      ids.insert(id * 10.0f, id);
+    ids.publish();
+    auto named = ids.snapshot().getRange(5.0f, 25.0f, rows);
+    if (named.size() != 2 || named[0] != &rows[1] || named[1] != &rows[2]) {
+      std::cerr << "getRange with rows did not resolve the ids\n";
+      return 1;
+    }
+
+    std::cout << "Test passed. Versioned B+ tree snapshots stay consistent."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,175 @@
+#include "../src/structures/paged_bplustree.hh"
+#include "range_checks.hh"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+using Tree = PagedBPlusTree<int, int>;
+
+// The paged tree must answer exactly like the sorted pairs.
+bool check_tree(Tree &tree, const std::vector<std::pair<int, int>> &sorted,
+                const std::string &name) {
+  if (tree.size() != sorted.size()) {
+    std::cerr << name << ": holds " << tree.size() << " values, expected "
+              << sorted.size() << "\n";
+    return false;
+  }
+  return check_ranges(tree, sorted, name) && check_search(tree, sorted, name);
+}
+
+int main() {
+  const std::string path = "test11_tree.pages";
+  try {
+    std::vector<std::pair<int, int>> sorted = make_sorted_pairs();
+    std::vector<std::pair<int, int>> shuffled = sorted;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(13));
+
+    std::remove(path.c_str());
+    {
+      // A small order and a pool far smaller than the tree, so inserts split
+      // at every level and pages are evicted and read back all the time.
+      Tree tree(path, 4, 4);
+      for (const auto &kv : shuffled)
+        tree.insert(kv.first, kv.second);
+      if (!check_tree(tree, sorted, "insert"))
+        return 1;
+      if (tree.height() < 4 || tree.poolStats().evictions == 0) {
+        std::cerr << "The test tree should outgrow its pool\n";
+        return 1;
+      }
+    }
+    {
+      // Everything must survive closing and reopening the file.
+      Tree reopened(path, 8);
+      if (reopened.getOrder() != 4 || !check_tree(reopened, sorted, "reopen"))
+        return 1;
+      reopened.insert(150, 3000);
+      if (reopened.countRange(150, 150) != 4) {
+        std::cerr << "insert after reopening was lost\n";
+        return 1;
+      }
+
+      bool threw = false;
+      try {
+        Tree wrong(path + ".other", 8, 2);
+      } catch (const std::invalid_argument &) {
+        threw = true;
+      }
+      if (!threw) {
+        std::cerr << "An order below 3 should throw\n";
+        return 1;
+      }
+    }
+
+    {
+      // A split needs only the node and its new sibling pinned.
+      std::remove(path.c_str());
+      Tree tight(path, Tree::minPoolPages, 4);
+      for (const auto &kv : shuffled)
+        tight.insert(kv.first, kv.second);
+      if (!check_tree(tight, sorted, "insert with a 2-page pool"))
+        return 1;
+    }
+
+    for (double fill : {1.0, 0.7}) {
+      std::string name = "bulkLoad " + std::to_string(fill);
+      std::remove(path.c_str());
+      {
+        Tree bulk(path, 4, 5);
+        bulk.bulkLoad(sorted, fill);
+        if (!check_tree(bulk, sorted, name))
+          return 1;
+        bulk.insert(150, 3000);
+        if (bulk.countRange(150, 150) != 4) {
+          std::cerr << name << ": insert after bulkLoad was lost\n";
+          return 1;
+        }
+      }
+      Tree reopened(path, 4);
+      if (reopened.size() != sorted.size() + 1) {
+        std::cerr << name << ": reopening lost entries\n";
+        return 1;
+      }
+    }
+
+    {
+      // A low fill with order 3 puts one entry in each leaf and two children
+      // in each internal node. Even spreading must not leave a node with one
+      // child, so the height stays within 1 + log2(leaves).
+      std::remove(path.c_str());
+      Tree sparse(path, 4, 3);
+      sparse.bulkLoad(sorted, 0.5);
+      size_t bound =
+          1 + static_cast<size_t>(std::floor(std::log2(sorted.size())));
+      if (!check_tree(sparse, sorted, "bulkLoad 0.5 (order 3)"))
+        return 1;
+      if (sparse.height() > bound) {
+        std::cerr << "bulkLoad 0.5 (order 3): height " << sparse.height()
+                  << ", expected at most " << bound << "\n";
+        return 1;
+      }
+    }
+
+    {
+      // The default order fills a page: a range scan of a few hundred keys
+      // should read only a handful of pages.
+      Tree wide(path + ".wide", 16);
+      wide.bulkLoad(sorted);
+      wide.resetPoolStats();
+      wide.getRange(100, 200);
+      auto stats = wide.poolStats();
+      if (wide.getOrder() != Tree::maxOrder() ||
+          stats.hits + stats.misses > wide.height() + 2) {
+        std::cerr << "A range scan touched more pages than its path\n";
+        return 1;
+      }
+    }
+    std::remove((path + ".wide").c_str());
+
+    {
+      std::ofstream(path + ".other") << "not a tree, just some text that "
+                                        "is long enough to fill a page\n"
+                                     << std::string(page_size, 'x');
+    }
+    bool threw = false;
+    try {
+      Tree wrong(path + ".other", 8);
+    } catch (const std::runtime_error &) {
+      threw = true;
+    }
+    std::remove((path + ".other").c_str());
+    if (!threw) {
+      std::cerr << "Opening a file that is not a tree should throw\n";
+      return 1;
+    }
+
+    std::vector<std::string> rows = {"zero", "one", "two", "three"};
+    {
+      PagedBPlusTree<float, RowId> ids(path + ".ids", 4, 3);
+      for (RowId id : {2, 0, 3, 1})
+        ids.insert(id * 10.0f, id);
+      auto named = ids.getRange(5.0f, 25.0f, rows);
+      if (named.size() != 2 || named[0] != &rows[1] || named[1] != &rows[2]) {
+        std::cerr << "getRange with rows did not resolve the ids\n";
+        return 1;
+      }
+    }
+    std::remove((path + ".ids").c_str());
+    std::remove(path.c_str());
+
+    std::cout << "Test passed. Paged B+ tree matches the sorted input."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    std::remove(path.c_str());
+    return 1;
+  }
+}
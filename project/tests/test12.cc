@@ -0,0 +1,64 @@
+#include "../src/structures/bucket_quadtree.hh"
+#include "spatial_checks.hh"
+#include <SFML/System/Vector2.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Some points fall outside the starting bounds, so the root has to grow.
+static const PointMix mix = {14,    -50.0f, 150.0f,         3000,
+                             {30.0f, 70.0f}, 0.05f, 3000,
+                             {12.5f, 12.5f}, 500};
+
+int main() {
+  try {
+    std::vector<sf::Vector2f> points = make_points(mix);
+    std::vector<sf::Vector2f> centers = make_centers(mix, 60);
+    for (size_t bucket : {1, 4, 16, 64}) {
+      std::string name = "bucket " + std::to_string(bucket);
+      BucketQuadtree<sf::Vector2f> tree(0.0f, 100.0f, 0.0f, 100.0f, bucket);
+      for (sf::Vector2f p : points)
+        tree.add_item(sf::Vector2f(p));
+      if (!check_radius_search(tree, points, centers,
+                               {0.0f, 0.1f, 5.0f, 40.0f, 500.0f}, name))
+        return 1;
+
+      QuadtreeStats stats = tree.stats();
+      if (stats.items != points.size() ||
+          stats.max_depth > BucketQuadtree<sf::Vector2f>::max_depth + 1) {
+        std::cerr << name << ": holds " << stats.items
+                  << " items at depth " << stats.max_depth << "\n";
+        return 1;
+      }
+    }
+
+    // Bigger buckets mean fewer nodes for the same points.
+    BucketQuadtree<sf::Vector2f> small(1), large(64);
+    for (sf::Vector2f p : points) {
+      small.add_item(std::make_unique<sf::Vector2f>(p));
+      large.add_item(sf::Vector2f(p));
+    }
+    if (large.stats().nodes * 8 > small.stats().nodes) {
+      std::cerr << "Buckets of 64 should need far fewer nodes than of 1\n";
+      return 1;
+    }
+
+    bool threw = false;
+    try {
+      BucketQuadtree<sf::Vector2f> empty(0);
+    } catch (const std::invalid_argument &) {
+      threw = true;
+    }
+    if (!threw) {
+      std::cerr << "A bucket size of 0 should throw\n";
+      return 1;
+    }
+
+    std::cout << "Test passed. Bucketed quadtree matches brute force."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
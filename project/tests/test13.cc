@@ -0,0 +1,81 @@
+#include "../src/structures/quadtree.hh"
+#include "spatial_checks.hh"
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Some points fall outside the starting bounds, so the root has to grow.
+static const PointMix mix = {16,    -50.0f, 150.0f,         2000,
+                             {30.0f, 70.0f}, 0.5f, 1000,
+                             {12.5f, 12.5f}, 20};
+
+int main() {
+  try {
+    std::vector<sf::Vector2f> points = make_points(mix);
+    std::mt19937 rng(mix.seed + 2);
+    std::uniform_real_distribution<float> uniform(mix.low, mix.high);
+
+    Quadtree<sf::Vector2f> tree(0.0f, 100.0f, 0.0f, 100.0f);
+    for (sf::Vector2f p : points)
+      tree.add_item(std::make_unique<sf::Vector2f>(p));
+
+    for (int q = 0; q < 200; q++) {
+      float x = uniform(rng), y = uniform(rng);
+      float w = q % 4 == 0 ? 0.0f : std::abs(uniform(rng)) / (q % 3 + 1);
+      float h = q % 5 == 0 ? 0.0f : std::abs(uniform(rng)) / (q % 3 + 1);
+      if (q == 0)
+        x = y = 12.5f;
+
+      std::vector<sf::Vector2f> expected;
+      for (sf::Vector2f p : points) {
+        if (p.x >= x && p.x <= x + w && p.y >= y && p.y <= y + h)
+          expected.push_back(p);
+      }
+      std::sort(expected.begin(), expected.end(), less_point);
+      std::vector<sf::Vector2f> got =
+          sorted_positions(tree.find_in_rect(x, x + w, y, y + h));
+      if (got != expected) {
+        std::cerr << "find_in_rect(" << x << ", " << x + w << ", " << y
+                  << ", " << y + h << ") found " << got.size()
+                  << " points, expected " << expected.size() << "\n";
+        return 1;
+      }
+    }
+
+    std::vector<sf::Vector2f> centers = make_centers(mix, 100);
+    centers.push_back({-500.0f, 400.0f});
+    for (sf::Vector2f center : centers) {
+      for (size_t k : {0, 1, 10, 25, 5000}) {
+        std::vector<float> expected;
+        for (sf::Vector2f p : points)
+          expected.push_back((p - center).lengthSquared());
+        std::sort(expected.begin(), expected.end());
+        expected.resize(std::min(k, expected.size()));
+
+        std::vector<float> got;
+        for (sf::Vector2f *p : tree.find_k_nearest(center, k))
+          got.push_back((*p - center).lengthSquared());
+        // Ties may come back in any order, but the distances, nearest
+        // first, must match.
+        if (got != expected) {
+          std::cerr << "find_k_nearest((" << center.x << ", " << center.y
+                    << "), " << k << ") returned " << got.size()
+                    << " points, not the nearest " << expected.size()
+                    << "\n";
+          return 1;
+        }
+      }
+    }
+
+    std::cout << "Test passed. Quadtree rect and k-nearest queries match "
+                 "brute force."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,58 @@
+#include "../src/structures/morton_quadtree.hh"
+#include "spatial_checks.hh"
+#include <SFML/System/Vector2.hpp>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static const PointMix mix = {17,    -50.0f, 150.0f,          3000,
+                             {30.0f, 70.0f}, 0.01f, 2000,
+                             {12.5f, 12.5f}, 300};
+
+int main() {
+  try {
+    std::vector<sf::Vector2f> points = make_points(mix);
+    std::vector<sf::Vector2f> centers = make_centers(mix, 60);
+
+    for (size_t leaf : {1, 16, 100}) {
+      MortonQuadtree<sf::Vector2f> tree(points, leaf);
+      std::string name = "leaf size " + std::to_string(leaf);
+      if (tree.size() != points.size() ||
+          tree.stats().items != points.size()) {
+        std::cerr << name << ": holds " << tree.size() << " items\n";
+        return 1;
+      }
+      if (!check_radius_search(tree, points, centers,
+                               {0.0f, 0.05f, 5.0f, 40.0f, 500.0f}, name))
+        return 1;
+    }
+
+    // Rebuilding replaces the contents; an empty tree finds nothing.
+    MortonQuadtree<sf::Vector2f> tree(points);
+    tree.build({{1.0f, 1.0f}});
+    if (tree.find_in_radius({1.0f, 1.0f}, 0.0f).size() != 1 ||
+        tree.find_in_radius({30.0f, 70.0f}, 1.0f).size() != 0) {
+      std::cerr << "build should replace the contents\n";
+      return 1;
+    }
+    tree.build({});
+    if (!tree.find_in_radius({1.0f, 1.0f}, 100.0f).empty()) {
+      std::cerr << "An empty tree should find nothing\n";
+      return 1;
+    }
+
+    try {
+      MortonQuadtree<sf::Vector2f> bad(0);
+      std::cerr << "leaf_size 0 should throw\n";
+      return 1;
+    } catch (const std::invalid_argument &) {
+    }
+
+    std::cout << "Test passed. Morton quadtree matches brute force."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,82 @@
+#include "../src/structures/quadtree.hh"
+#include "spatial_checks.hh"
+#include <SFML/System/Vector2.hpp>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+struct Listing {
+  sf::Vector2f position;
+  float price;
+};
+
+template <> sf::Vector2f get_position<Listing>(const Listing &l) {
+  return l.position;
+}
+
+struct PriceOf {
+  float operator()(const Listing &l) const { return l.price; }
+};
+
+// Some points fall outside the starting bounds, so the root has to grow.
+static const PointMix mix = {18,    -50.0f, 150.0f,         2000,
+                             {30.0f, 70.0f}, 0.5f, 1000,
+                             {12.5f, 12.5f}, 20};
+
+int main() {
+  try {
+    std::mt19937 rng(mix.seed + 2);
+    std::uniform_real_distribution<float> uniform(mix.low, mix.high);
+    std::uniform_real_distribution<float> price(1000.0f, 9000.0f);
+    std::vector<Listing> listings;
+    for (sf::Vector2f p : make_points(mix))
+      listings.push_back({p, price(rng)});
+
+    Quadtree<Listing, PriceOf> tree(0.0f, 100.0f, 0.0f, 100.0f);
+    for (const Listing &l : listings)
+      tree.add_item(std::make_unique<Listing>(l));
+
+    QuadtreeAggregate all = tree.aggregate();
+    if (all.count != listings.size()) {
+      std::cerr << "aggregate() counts " << all.count << " listings\n";
+      return 1;
+    }
+
+    for (int q = 0; q < 300; q++) {
+      sf::Vector2f center{uniform(rng), uniform(rng)};
+      float radius = std::abs(uniform(rng)) / (q % 4 + 1);
+      if (q == 0)
+        center = {12.5f, 12.5f}, radius = 0.0f;
+      if (q == 1)
+        radius = 1000.0f;
+
+      QuadtreeAggregate expected;
+      for (Listing *l : tree.find_in_radius(center, radius))
+        expected.add(l->price);
+      QuadtreeAggregate got = tree.aggregate_in_radius(center, radius);
+      if (got.count != expected.count || got.min != expected.min ||
+          got.max != expected.max ||
+          std::abs(got.sum - expected.sum) > 1e-9 * expected.sum) {
+        std::cerr << "aggregate_in_radius((" << center.x << ", " << center.y
+                  << "), " << radius << ") gave count " << got.count
+                  << " sum " << got.sum << ", expected count "
+                  << expected.count << " sum " << expected.sum << "\n";
+        return 1;
+      }
+    }
+
+    QuadtreeAggregate none = tree.aggregate_in_radius({1000.0f, 1000.0f}, 1.0f);
+    if (none.count != 0 || none.mean() != 0.0) {
+      std::cerr << "A search far away should aggregate nothing\n";
+      return 1;
+    }
+
+    std::cout << "Test passed. Quadtree aggregates match its searches."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,88 @@
+#include "../src/structures/quadtree_index.hh"
+#include "spatial_checks.hh"
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+// Enough uniform points for the quadrants to be built on threads.
+static const PointMix mix = {19,      -500.0f, 1500.0f,       150000,
+                             {300.0f, 700.0f}, 0.01f, 5000,
+                             {125.0f, 125.0f}, 500};
+
+int main() {
+  try {
+    std::vector<sf::Vector2f> points = make_points(mix);
+    std::vector<sf::Vector2f> centers = make_centers(mix, 30);
+
+    QuadtreeIndex<sf::Vector2f> serial(points, 16, 1);
+    QuadtreeIndex<sf::Vector2f> parallel(points, 16, 8);
+    QuadtreeIndex<sf::Vector2f> coarse(points, 200, 2);
+    if (serial.size() != points.size() ||
+        serial.stats().nodes != parallel.stats().nodes) {
+      std::cerr << "Thread count should not change the tree\n";
+      return 1;
+    }
+
+    if (!check_radius_search(serial, points, centers,
+                             {0.0f, 0.05f, 20.0f, 150.0f, 5000.0f},
+                             "leaf size 16") ||
+        !check_radius_search(coarse, points, centers, {0.0f, 20.0f, 150.0f},
+                             "leaf size 200"))
+      return 1;
+
+    // Row results name the same rows, and the tree does not depend on the
+    // thread count, so neither does their order.
+    for (sf::Vector2f center : centers) {
+      for (float radius : {0.0f, 20.0f, 150.0f}) {
+        std::vector<RowId> rows = serial.find_rows_in_radius(center, radius);
+        if (parallel.find_rows_in_radius(center, radius) != rows) {
+          std::cerr << "Serial and parallel builds answer differently\n";
+          return 1;
+        }
+        std::sort(rows.begin(), rows.end());
+        if (rows != rows_in_radius(points, center, radius)) {
+          std::cerr << "find_rows_in_radius((" << center.x << ", "
+                    << center.y << "), " << radius << ") found "
+                    << rows.size() << " rows\n";
+          return 1;
+        }
+      }
+    }
+
+    // 15102.9971 + (32294.8457 - 15102.9971) rounds below 32294.8457 in
+    // float; the farthest point must still be inside the root.
+    std::vector<sf::Vector2f> extremes = {{15102.9971f, 15102.9971f},
+                                          {32294.8457f, 32294.8457f}};
+    for (int i = 0; i < 100; i++)
+      extremes.push_back({20000.0f + i, 20000.0f + i});
+    QuadtreeIndex<sf::Vector2f> rounded(extremes, 1, 1);
+    for (sf::Vector2f p : {extremes[0], extremes[1]}) {
+      if (rounded.find_rows_in_radius(p, 0.0f).size() != 1) {
+        std::cerr << "The point at (" << p.x << ", " << p.y
+                  << ") should be found with radius 0\n";
+        return 1;
+      }
+    }
+
+    std::vector<sf::Vector2f> none;
+    QuadtreeIndex<sf::Vector2f> empty(none);
+    if (!empty.find_in_radius({0.0f, 0.0f}, 100.0f).empty()) {
+      std::cerr << "An empty index should find nothing\n";
+      return 1;
+    }
+    try {
+      QuadtreeIndex<sf::Vector2f> bad(points, 0);
+      std::cerr << "leaf_size 0 should throw\n";
+      return 1;
+    } catch (const std::invalid_argument &) {
+    }
+
+    std::cout << "Test passed. Quadtree index matches brute force."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
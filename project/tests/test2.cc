@@ -14,9 +14,11 @@ House test_value(float price) {
 int main(){
     try{
         RedBlackTree redblacktree;
+        std::vector<House> houses;                      //the tree stores rows of this
 
         for (int i = 1; i <= 5; ++i){                   //inserts values 1-5 for the price
-            redblacktree.insert(test_value(i));
+            houses.push_back(test_value(i));
+            redblacktree.insert(houses.back().price, static_cast<RowId>(houses.size() - 1));
         }
         std::map<float, Color> actual;                  //holds what the actual tree should look like
         redblacktree.inorder_traversal(redblacktree.root, actual);
@@ -46,7 +48,7 @@ int main(){
         }
 
         //checks if range is correct
-        auto range_nodes = redblacktree.price_range(2, 4);
+        auto range_nodes = redblacktree.price_range(2, 4, houses);
         std::vector<float> expectedrange = {2, 3, 4};
         if (range_nodes.size() != expectedrange.size()){
             std::cerr << "price_range returned " << range_nodes.size()
@@ -0,0 +1,185 @@
+#include "../src/io/house_parser.hh"
+#include "../src/io/house_writer.hh"
+#include "../src/io/snapshot.hh"
+#include "../src/lib.hh"
+#include "house_checks.hh"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+static const char *test_file = "test3_data";
+static const char *test_snapshot = "test3_snapshot";
+
+House make_house(const std::string &number, float x, float y, float price,
+                 unsigned int rooms, const std::string &features) {
+  House h;
+  h.address = Address{number, "se", "12th", "st"};
+  h.position = {x, y};
+  h.price = price;
+  h.area = 1234.5f;
+  h.room_count = rooms;
+  h.bathroom_count = rooms / 2 + 1;
+  h.features = features;
+  return h;
+}
+
+int main() {
+  try {
+    std::vector<House> written = {
+        make_house("1200", 10.25f, 3999.5f, 450000.75f, 3, "Pool"),
+        make_house("7", 0.0f, 0.0f, 2999999.0f, 9,
+                   "Pool, Fireplace, Home Office"),
+        make_house("18000", 36000.0f, 120.75f, 800000.0f, 1, ""),
+    };
+
+    {
+      std::ofstream out(test_file);
+      for (const House &h : written) {
+        out << h;
+        // Blank lines should be ignored by every loader.
+        out << "\n";
+      }
+    }
+
+    auto streamed = load_file(test_file, LoadMode::Stream);
+    auto mapped = load_file(test_file, LoadMode::Mapped);
+    std::remove(test_file);
+
+    if (streamed.size() != written.size() || mapped.size() != written.size()) {
+      std::cerr << "Expected " << written.size() << " houses, stream loaded "
+                << streamed.size() << " and mapped loaded " << mapped.size()
+                << "\n";
+      return 1;
+    }
+
+    for (size_t i = 0; i < written.size(); ++i) {
+      if (!same_house(streamed[i], written[i])) {
+        std::cerr << "Stream loader mismatch at row " << i << ": "
+                  << streamed[i].to_string() << "\n";
+        return 1;
+      }
+      if (!same_house(mapped[i], written[i])) {
+        std::cerr << "Mapped loader mismatch at row " << i << ": "
+                  << mapped[i].to_string() << "\n";
+        return 1;
+      }
+    }
+
+    // The parallel parser must give the same rows in the same order, however
+    // the chunks fall.
+    std::ostringstream many;
+    std::vector<House> expected;
+    for (int i = 0; i < 1000; ++i) {
+      expected.push_back(written[i % written.size()]);
+      expected.back().price = static_cast<float>(i);
+      many << expected.back();
+    }
+    std::string text = many.str();
+    for (unsigned int threads : {1u, 2u, 3u, 7u, 64u}) {
+      std::vector<House> parsed;
+      parse_house_lines_parallel(text.data(), text.data() + text.size(), parsed,
+                                 threads);
+      if (parsed.size() != expected.size()) {
+        std::cerr << "Parallel parse with " << threads << " threads gave "
+                  << parsed.size() << " houses\n";
+        return 1;
+      }
+      for (size_t i = 0; i < expected.size(); ++i) {
+        if (!same_house(parsed[i], expected[i])) {
+          std::cerr << "Parallel parse with " << threads
+                    << " threads mismatch at row " << i << "\n";
+          return 1;
+        }
+      }
+    }
+
+    // The buffered writer must produce exactly what operator<< does.
+    std::ostringstream streamed_text;
+    for (const House &h : expected)
+      streamed_text << h;
+    for (unsigned int threads : {1u, 4u}) {
+      std::ostringstream buffered_text;
+      write_houses(buffered_text, expected, threads);
+      if (buffered_text.str() != streamed_text.str()) {
+        std::cerr << "write_houses with " << threads
+                  << " threads differs from operator<<\n";
+        return 1;
+      }
+    }
+
+    // A binary snapshot must round trip and be detected by load_file.
+    if (!write_snapshot(test_snapshot, written)) {
+      std::cerr << "Could not write snapshot\n";
+      return 1;
+    }
+    auto restored = load_file(test_snapshot, LoadMode::Stream);
+    std::remove(test_snapshot);
+    if (restored.size() != written.size()) {
+      std::cerr << "Snapshot loaded " << restored.size() << " houses, expected "
+                << written.size() << "\n";
+      return 1;
+    }
+    for (size_t i = 0; i < written.size(); ++i) {
+      if (!same_house(restored[i], written[i])) {
+        std::cerr << "Snapshot mismatch at row " << i << ": "
+                  << restored[i].to_string() << "\n";
+        return 1;
+      }
+    }
+
+    // Truncated or corrupt snapshots are rejected without allocating from
+    // the header's counts.
+    std::stringstream good;
+    write_snapshot(good, written);
+    const std::string image = good.str();
+    auto corrupt = [&](std::uint64_t rows, std::uint64_t heap) {
+      SnapshotHeader header;
+      std::memcpy(&header, image.data(), sizeof(header));
+      header.row_count = rows;
+      header.heap_size = heap;
+      std::string bytes = image;
+      std::memcpy(&bytes[0], &header, sizeof(header));
+      return bytes;
+    };
+    const std::vector<std::pair<std::string, std::string>> bad_images = {
+        {"truncated", image.substr(0, image.size() - 1)},
+        {"header only", image.substr(0, sizeof(SnapshotHeader))},
+        {"huge row count", corrupt(std::uint64_t(1) << 60, 0)},
+        {"overflowing row count", corrupt(~std::uint64_t(0) / 5, 0)},
+        {"huge heap", corrupt(written.size(), ~std::uint64_t(0))},
+    };
+    for (const auto &[name, bytes] : bad_images) {
+      std::istringstream in(bytes);
+      SnapshotColumns columns;
+      if (read_snapshot(in, columns)) {
+        std::cerr << "A " << name << " snapshot should not load\n";
+        return 1;
+      }
+      std::ofstream(test_snapshot, std::ios::binary) << bytes;
+      auto loaded = load_file(test_snapshot, LoadMode::Stream);
+      std::remove(test_snapshot);
+      if (!loaded.empty()) {
+        std::cerr << "load_file should give no houses for a " << name
+                  << " snapshot\n";
+        return 1;
+      }
+    }
+
+    if (!load_file("test3_missing_file", LoadMode::Mapped).empty()) {
+      std::cerr << "Loading a missing file should give no houses\n";
+      return 1;
+    }
+
+    std::cout << "Test passed. Loaders agree." << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
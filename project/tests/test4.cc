@@ -0,0 +1,112 @@
+#include "../src/house_store.hh"
+#include "../src/io/snapshot.hh"
+#include "house_checks.hh"
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+static const char *test_snapshot = "test4_snapshot";
+
+House test_house(float price, const std::string &features) {
+  House h;
+  h.address = Address{std::to_string(static_cast<int>(price)), "se", "3rd",
+                      "ave"};
+  h.position = {price / 2, price / 4};
+  h.price = price;
+  h.area = price / 1000;
+  h.room_count = 4;
+  h.bathroom_count = 2;
+  h.features = features;
+  return h;
+}
+
+bool check_store(const HouseStore &store, const std::vector<House> &houses,
+                 const char *what) {
+  if (store.size() != houses.size()) {
+    std::cerr << what << ": store has " << store.size() << " rows, expected "
+              << houses.size() << "\n";
+    return false;
+  }
+  for (RowId id = 0; id < store.size(); ++id) {
+    if (!same_house(store.house(id), houses[id])) {
+      std::cerr << what << ": row " << id << " does not round trip\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+int main() {
+  try {
+    std::vector<House> houses;
+    for (int i = 0; i < 50; ++i) {
+      houses.push_back(test_house(1000.0f * ((i * 7) % 50),
+                                  i % 3 ? "Pool, Fireplace" : ""));
+    }
+
+    HouseStore store;
+    for (size_t i = 0; i < houses.size(); ++i) {
+      if (store.add(houses[i]) != i) {
+        std::cerr << "add returned the wrong row id for row " << i << "\n";
+        return 1;
+      }
+    }
+    if (!check_store(store, houses, "add"))
+      return 1;
+
+    // price_range must match a scan of the original rows, in row order.
+    std::vector<RowId> expected;
+    for (size_t i = 0; i < houses.size(); ++i) {
+      if (10000 <= houses[i].price && houses[i].price <= 20000)
+        expected.push_back(static_cast<RowId>(i));
+    }
+    if (store.price_range(10000, 20000) != expected) {
+      std::cerr << "price_range does not match a scan of the houses\n";
+      return 1;
+    }
+
+    // Feature masks are parsed from the strings, and combine with price.
+    FeatureMask wanted = feature_bit("Pool") | feature_bit("Fireplace");
+    if (parse_features(" Fireplace,Pool ,Nonsense") != wanted ||
+        features_to_string(wanted) != "Pool, Fireplace") {
+      std::cerr << "Feature names do not round trip through a mask\n";
+      return 1;
+    }
+    std::vector<RowId> expected_with_features;
+    for (RowId id : expected) {
+      if (houses[id].features == "Pool, Fireplace")
+        expected_with_features.push_back(id);
+    }
+    if (store.price_range(10000, 20000, wanted) != expected_with_features ||
+        store.filter_features(expected, wanted) != expected_with_features) {
+      std::cerr << "Feature filter does not match a scan of the houses\n";
+      return 1;
+    }
+    if (!store.price_range(0, 100000, feature_bit("Pool") |
+                                          feature_bit("Home Office"))
+             .empty()) {
+      std::cerr << "No house has both Pool and Home Office\n";
+      return 1;
+    }
+
+    // A store loaded from a snapshot adopts its columns as is.
+    if (!write_snapshot(test_snapshot, houses)) {
+      std::cerr << "Could not write snapshot\n";
+      return 1;
+    }
+    HouseStore loaded = load_store(test_snapshot);
+    std::remove(test_snapshot);
+    if (!check_store(loaded, houses, "load_store"))
+      return 1;
+    if (loaded.price_range(10000, 20000, wanted) != expected_with_features) {
+      std::cerr << "Snapshot store lost its feature masks\n";
+      return 1;
+    }
+
+    std::cout << "Test passed. HouseStore round trips." << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,148 @@
+#include "../src/ingest.hh"
+#include "../src/io/snapshot.hh"
+#include "house_checks.hh"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static const char *test_file = "test5_data";
+static const char *snapshot_file = "test5_data.snap";
+
+int main() {
+  try {
+    std::vector<House> houses;
+    {
+      std::ofstream out(test_file);
+      for (int i = 0; i < 1000; ++i) {
+        House h;
+        h.address = Address{std::to_string(i), "se", "1st", "ave"};
+        h.position = {static_cast<float>(i), 0};
+        h.price = static_cast<float>((i * 37) % 1000);
+        h.area = 100;
+        h.room_count = 2;
+        h.bathroom_count = 1;
+        h.features = "Pool";
+        out << h;
+        houses.push_back(h);
+      }
+    }
+
+    int found = 0;
+    {
+      Ingest ingest(test_file, 64);
+
+      // Searching while the worker is still indexing must be safe.
+      while (!ingest.done()) {
+        auto partial = ingest.search(IndexKind::BPlus3, 0, 1000);
+        if (partial.size() > ingest.expected()) {
+          std::cerr << "Search returned more rows than the file has\n";
+          return 1;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+
+      if (ingest.indexed() != 1000 || ingest.expected() != 1000) {
+        std::cerr << "Expected 1000 indexed rows, got " << ingest.indexed()
+                  << "\n";
+        return 1;
+      }
+
+      auto [low, high] = ingest.price_bounds();
+      if (low != 0 || high != 999) {
+        std::cerr << "Price bounds are " << low << ".." << high << "\n";
+        return 1;
+      }
+
+      for (IndexKind kind :
+           {IndexKind::RedBlack, IndexKind::BPlus3, IndexKind::BPlus21}) {
+        auto result = ingest.search(kind, 100, 199);
+        if (result.size() != 100) {
+          std::cerr << "Index " << static_cast<int>(kind) << " found "
+                    << result.size() << " houses, expected 100\n";
+          return 1;
+        }
+        for (RowId row : result) {
+          float price = ingest.house(row).price;
+          if (price < 100 || price > 199) {
+            std::cerr << "Index " << static_cast<int>(kind)
+                      << " returned price " << price << "\n";
+            return 1;
+          }
+        }
+
+        // Pages are slices of the full result.
+        if (ingest.search_count(kind, 100, 199) != 100) {
+          std::cerr << "Index " << static_cast<int>(kind)
+                    << " miscounted its matches\n";
+          return 1;
+        }
+        for (size_t first : {0, 4, 96, 98, 100, 150}) {
+          auto page = ingest.search_page(kind, 100, 199, first, 4);
+          size_t expected = first < 100 ? std::min<size_t>(4, 100 - first) : 0;
+          bool same = page.size() == expected;
+          for (size_t i = 0; same && i < page.size(); i++)
+            same = page[i] == result[first + i];
+          if (!same) {
+            std::cerr << "Index " << static_cast<int>(kind)
+                      << " gave a wrong page at " << first << "\n";
+            return 1;
+          }
+        }
+      }
+
+      found = static_cast<int>(ingest.rows(0, 5000).size());
+    }
+
+    if (found != 1000) {
+      std::cerr << "rows() returned " << found << " houses, expected 1000\n";
+      return 1;
+    }
+
+    // A snapshot's columns become the store as read.
+    write_snapshot(snapshot_file, houses);
+    {
+      Ingest ingest(snapshot_file, 64);
+      while (!ingest.done())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      bool same = ingest.indexed() == houses.size();
+      for (RowId row = 0; same && row < houses.size(); row++)
+        same = same_house(ingest.house(row), houses[row]);
+      if (!same || ingest.search(IndexKind::RedBlack, 100, 199).size() != 100) {
+        std::cerr << "Ingesting the snapshot lost rows\n";
+        return 1;
+      }
+    }
+
+    // Files past the row limit are cut off there, whatever their format,
+    // and the default limit is what the red-black tree can hold.
+    if (Ingest::max_rows > RBTree::nil) {
+      std::cerr << "Ingest accepts more rows than the red-black tree holds\n";
+      return 1;
+    }
+    for (const char *file : {test_file, snapshot_file}) {
+      Ingest ingest(file, 64, 300);
+      while (!ingest.done())
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      if (ingest.indexed() != 300 || ingest.expected() != 300 ||
+          ingest.search(IndexKind::RedBlack, 0, 1000).size() != 300 ||
+          ingest.search_count(IndexKind::BPlus21, 0, 1000) != 300) {
+        std::cerr << file << ": expected the first 300 rows, got "
+                  << ingest.indexed() << "\n";
+        return 1;
+      }
+    }
+    std::remove(test_file);
+    std::remove(snapshot_file);
+
+    std::cout << "Test passed. Background ingest indexed every row."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,159 @@
+#include "../src/structures/bplustree.hh"
+#include "range_checks.hh"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+bool check_tree(BPlusTree<int, int> &tree,
+                const std::vector<std::pair<int, int>> &sorted,
+                const std::string &name) {
+  return check_ranges(tree, sorted, name) && check_cursors(tree, name) &&
+         check_search(tree, sorted, name);
+}
+
+int main() {
+  try {
+    std::vector<std::pair<int, int>> sorted = make_sorted_pairs();
+
+    for (size_t order : {3, 4, 21, 64, 100}) {
+      std::string suffix = " (order " + std::to_string(order) + ")";
+
+      std::vector<std::pair<int, int>> shuffled = sorted;
+      std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(7));
+      BPlusTree<int, int> inserted(order);
+      for (const auto &kv : shuffled)
+        inserted.insert(kv.first, kv.second);
+      if (!check_tree(inserted, sorted, "insert" + suffix))
+        return 1;
+
+      for (double fill : {1.0, 0.7}) {
+        BPlusTree<int, int> bulk(order, sorted, fill);
+        std::string name = "bulkLoad " + std::to_string(fill) + suffix;
+        if (!check_tree(bulk, sorted, name))
+          return 1;
+
+        auto stats = bulk.getStats();
+        if (stats.keys != sorted.size()) {
+          std::cerr << name << ": holds " << stats.keys << " keys\n";
+          return 1;
+        }
+        // With `wanted` keys per leaf the keys need ceil(n / wanted) leaves,
+        // spread evenly; for big orders that is less than `wanted` each.
+        double wanted = std::max(1.0, static_cast<double>(
+                                          static_cast<size_t>(order * fill)));
+        double leaves = std::ceil(sorted.size() / wanted);
+        if (stats.leafFill * order < sorted.size() / leaves - 1) {
+          std::cerr << name << ": leaves are only " << stats.leafFill
+                    << " full\n";
+          return 1;
+        }
+
+        // Inserting after a bulk load must keep working.
+        bulk.insert(150, 3000);
+        if (bulk.getRange(150, 150).size() != 4) {
+          std::cerr << name << ": insert after bulkLoad was lost\n";
+          return 1;
+        }
+      }
+    }
+
+    // Erase and update keep every remaining entry reachable, with runs of
+    // duplicates that straddle leaves and nodes borrowing and merging.
+    for (size_t order : {3, 4, 5, 21}) {
+      std::string suffix = " (order " + std::to_string(order) + ")";
+      std::vector<std::pair<int, int>> model = sorted;
+      BPlusTree<int, int> tree(order, sorted);
+      std::mt19937 gen(static_cast<unsigned>(order));
+
+      for (int round = 0; round < 900; ++round) {
+        size_t pick = gen() % model.size();
+        auto entry = model[pick];
+        if (round % 3 == 0) {
+          // A price change: the value moves to a key three times its own.
+          int key = entry.second / 3;
+          if (!tree.update(entry.first, key, entry.second)) {
+            std::cerr << "update failed" << suffix << "\n";
+            return 1;
+          }
+          model[pick].first = key;
+        } else {
+          if (!tree.erase(entry.first, entry.second)) {
+            std::cerr << "erase failed" << suffix << "\n";
+            return 1;
+          }
+          model.erase(model.begin() + pick);
+        }
+        if (tree.erase(entry.first, -1) || tree.update(-5, 1, entry.second)) {
+          std::cerr << "erase/update of a missing entry succeeded" << suffix
+                    << "\n";
+          return 1;
+        }
+      }
+
+      std::sort(model.begin(), model.end());
+      auto all = tree.getRange(-1000, 1000);
+      std::vector<int> got, expected;
+      for (int *value : all)
+        got.push_back(*value);
+      for (const auto &kv : model)
+        expected.push_back(kv.second);
+      std::sort(got.begin(), got.end());
+      std::sort(expected.begin(), expected.end());
+      if (got != expected || tree.getStats().keys != model.size()) {
+        std::cerr << "Entries after erase/update are wrong" << suffix << "\n";
+        return 1;
+      }
+      for (const auto &kv : model) {
+        if (tree.getRange(kv.first, kv.first).empty() || !tree.search(kv.first)) {
+          std::cerr << "Key " << kv.first << " is unreachable" << suffix
+                    << "\n";
+          return 1;
+        }
+      }
+
+      for (const auto &kv : model)
+        tree.erase(kv.first, kv.second);
+      if (tree.getStats().keys != 0 || !tree.getRange(-1000, 1000).empty()) {
+        std::cerr << "Erasing everything should empty the tree" << suffix
+                  << "\n";
+        return 1;
+      }
+      tree.insert(1, 1);
+      if (!tree.search(1)) {
+        std::cerr << "Insert after emptying the tree was lost" << suffix
+                  << "\n";
+        return 1;
+      }
+    }
+
+    // Trees of row ids hand back the rows themselves.
+    std::vector<std::string> rows = {"zero", "one", "two", "three"};
+    BPlusTree<int, int> ids(3);
+    for (int id : {2, 0, 3, 1})
+      ids.insert(id * 10, id);
+    auto named = ids.getRange(5, 25, rows);
+    if (named.size() != 2 || *named[0] != "one" || *named[1] != "two" ||
+        named[0] != &rows[1]) {
+      std::cerr << "getRange with rows did not resolve the ids\n";
+      return 1;
+    }
+
+    BPlusTree<int, int> empty(4, {});
+    if (!empty.getRange(0, 10).empty() || empty.getStats().keys != 0 ||
+        empty.search(0)) {
+      std::cerr << "Bulk loading nothing should give an empty tree\n";
+      return 1;
+    }
+
+    std::cout << "Test passed. Bulk loaded trees match inserted ones."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
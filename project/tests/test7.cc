@@ -0,0 +1,184 @@
+#include "../src/lib.hh"
+#include "../src/structures/redblack.hh"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+House test_value(float price, unsigned int id) {
+    House h;
+    h.price = price;
+    h.room_count = id;
+    return h;
+}
+
+//returns the black height of node, or -1 if a red-black rule is broken below it
+int check_node(const RedBlackTree& tree, NodeIndex node, NodeIndex parent){
+    if (node == RedBlackTree::nil){
+        return 1;
+    }
+    const RBTree& n = tree.node(node);
+    if (n.parent() != parent){
+        return -1;
+    }
+    if (n.color() == Red && parent != RedBlackTree::nil && tree.node(parent).color() == Red){
+        return -1;
+    }
+    int left = check_node(tree, n.left, node);
+    int right = check_node(tree, n.right, node);
+    if (left < 0 || right < 0 || left != right){
+        return -1;
+    }
+    return left + (n.color() == Black ? 1 : 0);
+}
+
+//returns the number of nodes under node, or -1 if a stored size is wrong
+long check_sizes(const RedBlackTree& tree, NodeIndex node){
+    if (node == RedBlackTree::nil){
+        return 0;
+    }
+    const RBTree& n = tree.node(node);
+    long left = check_sizes(tree, n.left);
+    long right = check_sizes(tree, n.right);
+    if (left < 0 || right < 0 || n.size != left + right + 1){
+        return -1;
+    }
+    return left + right + 1;
+}
+
+bool is_valid(const RedBlackTree& tree){
+    if (check_sizes(tree, tree.root) != static_cast<long>(tree.size())){
+        return false;
+    }
+    if (tree.root != RedBlackTree::nil && tree.node(tree.root).color() != Black){
+        return false;
+    }
+    return check_node(tree, tree.root, RedBlackTree::nil) > 0;
+}
+
+int main(){
+    try{
+        std::mt19937 gen(3);
+        for (size_t n : {0, 1, 2, 3, 6, 7, 8, 100, 1023, 1024, 5000}){
+            //prices repeat so equal keys end up on both sides of a node
+            std::vector<House> houses;
+            for (size_t i = 0; i < n; ++i){
+                houses.push_back(test_value(static_cast<float>(gen() % 500), static_cast<unsigned int>(i)));
+            }
+
+            RedBlackTree inserted;
+            for (size_t i = 0; i < n; ++i){
+                inserted.insert(houses[i].price, static_cast<RowId>(i));
+            }
+
+            std::vector<std::pair<float, RowId>> sorted;
+            for (size_t i = 0; i < n; ++i){
+                sorted.push_back({houses[i].price, static_cast<RowId>(i)});
+            }
+            std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b){
+                return a.first < b.first;
+            });
+            RedBlackTree built;
+            built.build_from_sorted(sorted);
+
+            if (!is_valid(inserted)){
+                std::cerr << "insert(" << n << " houses) broke a red-black rule\n";
+                return 1;
+            }
+            if (!is_valid(built)){
+                std::cerr << "build_from_sorted(" << n << " houses) broke a red-black rule\n";
+                return 1;
+            }
+
+            //ranges must agree with the inserted tree, house for house
+            for (float low = -10; low < 520; low += 37){
+                for (float width : {0.0f, 5.0f, 100.0f, 600.0f}){
+                    auto expected = inserted.price_range(low, low + width, houses);
+                    auto got = built.price_range(low, low + width, houses);
+                    size_t matches = std::count_if(houses.begin(), houses.end(), [&](const House& h){
+                        return low <= h.price && h.price <= low + width;
+                    });
+                    if (got.size() != matches || expected.size() != matches){
+                        std::cerr << "price_range(" << low << ", " << low + width << ") on " << n
+                                  << " houses: built " << got.size() << ", inserted " << expected.size()
+                                  << ", expected " << matches << "\n";
+                        return 1;
+                    }
+                    for (size_t i = 0; i < got.size(); ++i){
+                        if (got[i]->price != expected[i]->price){
+                            std::cerr << "price_range order differs at " << i << "\n";
+                            return 1;
+                        }
+                    }
+
+                    //order statistics agree with the materialized ranges
+                    for (RedBlackTree* tree : {&inserted, &built}){
+                        auto range = tree->price_range(low, low + width);
+                        if (tree->count_in_range(low, low + width) != matches){
+                            std::cerr << "count_in_range(" << low << ", " << low + width << ") on " << n
+                                      << " houses is wrong\n";
+                            return 1;
+                        }
+                        for (size_t k = 0; k <= range.size(); k += 1 + range.size() / 16){
+                            RowId* row = tree->select_in_range(low, low + width, k);
+                            if (row != (k < range.size() ? range[k] : nullptr)){
+                                std::cerr << "select_in_range(" << low << ", " << low + width << ", " << k
+                                          << ") on " << n << " houses is wrong\n";
+                                return 1;
+                            }
+                        }
+                        if (tree->select_in_range(low, low + width, range.size())){
+                            std::cerr << "select_in_range past the end should give nullptr\n";
+                            return 1;
+                        }
+                    }
+                }
+            }
+
+            //search finds stored prices only
+            for (const House& h : houses){
+                RowId* found = built.search(h.price);
+                if (!found || houses[*found].price != h.price){
+                    std::cerr << "search(" << h.price << ") missed a stored price\n";
+                    return 1;
+                }
+            }
+            if (built.search(-1)){
+                std::cerr << "search found a price that was never stored\n";
+                return 1;
+            }
+
+            //rebuilding replaces the old contents
+            built.build_from_sorted(sorted);
+            if (built.price_range(-1, 1000).size() != n || built.size() != n){
+                std::cerr << "Rebuilding kept old nodes\n";
+                return 1;
+            }
+        }
+
+        //row pointers stay put while the tree keeps growing
+        RedBlackTree growing;
+        growing.insert(-5, 0);
+        RowId* first = growing.search(-5);
+        for (RowId i = 1; i < 20000; ++i){
+            growing.insert(static_cast<float>(i % 700), i);
+        }
+        if (first != growing.search(-5) || *first != 0 || !is_valid(growing)){
+            std::cerr << "Inserting moved an existing node\n";
+            return 1;
+        }
+        growing.clear();
+        if (growing.root != RedBlackTree::nil || growing.size() != 0 || !growing.price_range(0, 1000).empty()){
+            std::cerr << "clear left nodes behind\n";
+            return 1;
+        }
+
+        std::cout << "Test passed. Bulk built trees are valid and match inserted ones." << std::endl;
+        return 0;
+    }
+    catch(const std::exception& e){
+        std::cerr << "Test failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,64 @@
+#include "../src/structures/node_search.hh"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+// node_lower_bound / node_upper_bound must land where std::lower_bound /
+// std::upper_bound do for every node size, including runs of equal keys.
+template <typename K, typename Gen>
+bool check_bounds(const std::string &name, Gen next_key) {
+  std::mt19937 gen(8);
+  for (size_t n = 0; n <= 300; n += (n < 40 ? 1 : 37)) {
+    std::vector<K> keys;
+    for (size_t i = 0; i < n; ++i)
+      keys.push_back(next_key(gen));
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<K> probes = keys;
+    for (int i = 0; i < 20; ++i)
+      probes.push_back(next_key(gen));
+    for (const K &key : probes) {
+      size_t lower = std::lower_bound(keys.begin(), keys.end(), key) -
+                     keys.begin();
+      size_t upper = std::upper_bound(keys.begin(), keys.end(), key) -
+                     keys.begin();
+      if (node_lower_bound(keys.data(), n, key) != lower ||
+          node_upper_bound(keys.data(), n, key) != upper) {
+        std::cerr << name << ": wrong bound in a node of " << n << " keys\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+int main() {
+  try {
+    // Narrow key ranges so nodes are full of duplicates.
+    bool ok =
+        check_bounds<float>("float", [](std::mt19937 &gen) {
+          return static_cast<float>(gen() % 50) * 0.5f;
+        }) &&
+        check_bounds<std::int32_t>("int32", [](std::mt19937 &gen) {
+          return static_cast<std::int32_t>(gen() % 60) - 30;
+        }) &&
+        check_bounds<double>("double", [](std::mt19937 &gen) {
+          return static_cast<double>(gen() % 1000) / 7;
+        }) &&
+        check_bounds<std::string>("string", [](std::mt19937 &gen) {
+          return std::string(1, static_cast<char>('a' + gen() % 26));
+        });
+    if (!ok)
+      return 1;
+
+    std::cout << "Test passed. Node search matches std::lower_bound."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
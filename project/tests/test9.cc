@@ -0,0 +1,113 @@
+#include "../src/structures/flat_bplustree.hh"
+#include "range_checks.hh"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// The flat tree must answer exactly like a sorted array.
+template <typename Tree>
+bool check_tree(Tree &tree,
+                const std::vector<std::pair<int, int>> &sorted,
+                const std::string &name) {
+  if (!check_ranges(tree, sorted, name) || !check_cursors(tree, name) ||
+      !check_search(tree, sorted, name))
+    return false;
+  if (tree.getStats().keys != sorted.size()) {
+    std::cerr << name << ": holds " << tree.getStats().keys << " keys\n";
+    return false;
+  }
+  return true;
+}
+
+int main() {
+  try {
+    std::vector<std::pair<int, int>> sorted = make_sorted_pairs();
+
+    for (size_t order : {3, 4, 21, 64}) {
+      std::string suffix = " (order " + std::to_string(order) + ")";
+
+      std::vector<std::pair<int, int>> shuffled = sorted;
+      std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(9));
+      FlatBPlusTree<int, int> inserted(order);
+      for (const auto &kv : shuffled)
+        inserted.insert(kv.first, kv.second);
+      if (!check_tree(inserted, sorted, "insert" + suffix))
+        return 1;
+
+      if (inserted.nodeBytes() % FlatBPlusTree<int, int>::lineSize != 0) {
+        std::cerr << "Node blocks are not whole cache lines" << suffix
+                  << "\n";
+        return 1;
+      }
+
+      for (double fill : {1.0, 0.7}) {
+        FlatBPlusTree<int, int> bulk(order, sorted, fill);
+        std::string name = "bulkLoad " + std::to_string(fill) + suffix;
+        if (!check_tree(bulk, sorted, name))
+          return 1;
+
+        // Inserting after a bulk load must keep working.
+        bulk.insert(150, 3000);
+        if (bulk.getRange(150, 150).size() != 4) {
+          std::cerr << name << ": insert after bulkLoad was lost\n";
+          return 1;
+        }
+      }
+    }
+
+    // A compile-time order must give the same answers as the runtime one.
+    std::vector<std::pair<int, int>> shuffled = sorted;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(10));
+    FlatBPlusTree<int, int, 4> fixed;
+    for (const auto &kv : shuffled)
+      fixed.insert(kv.first, kv.second);
+    if (!check_tree(fixed, sorted, "insert (Order 4)"))
+      return 1;
+    FlatBPlusTree<int, int, 4> fixed_bulk(4, sorted, 0.7);
+    if (!check_tree(fixed_bulk, sorted, "bulkLoad (Order 4)"))
+      return 1;
+    if (fixed.getOrder() != 4 ||
+        fixed.nodeBytes() != FlatBPlusTree<int, int>(4).nodeBytes()) {
+      std::cerr << "Order 4 should lay nodes out like a runtime order of 4\n";
+      return 1;
+    }
+    bool threw = false;
+    try {
+      FlatBPlusTree<int, int, 4> wrong(5);
+    } catch (const std::invalid_argument &) {
+      threw = true;
+    }
+    if (!threw) {
+      std::cerr << "A runtime order that disagrees with Order should throw\n";
+      return 1;
+    }
+
+    std::vector<std::string> rows = {"zero", "one", "two", "three"};
+    FlatBPlusTree<int, int> ids(3);
+    for (int id : {2, 0, 3, 1})
+      ids.insert(id * 10, id);
+    auto named = ids.getRange(5, 25, rows);
+    if (named.size() != 2 || named[0] != &rows[1] || named[1] != &rows[2]) {
+      std::cerr << "getRange with rows did not resolve the ids\n";
+      return 1;
+    }
+
+    ids.clear();
+    if (!ids.getRange(0, 100).empty() || ids.search(10) ||
+        ids.getStats().bytes != 0) {
+      std::cerr << "clear should leave an empty tree\n";
+      return 1;
+    }
+
+    std::cout << "Test passed. Flat B+ tree matches the sorted input."
+              << std::endl;
+    return 0;
+  } catch (const std::exception &e) {
+    std::cerr << "Test failed: " << e.what() << std::endl;
+    return 1;
+  }
+}